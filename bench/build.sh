@@ -0,0 +1,20 @@
+#!/bin/bash
+
+INCLUDE="-Ibench/src -Ilibsatsu/src"
+DEFINES=""
+WARNINGS="-Wall -Wextra -Wshadow"
+LIBRARIES="-L. -lsatsu-bin -lm"
+CFLAGS="-std=c99 -pedantic -O3 -D_GNU_SOURCE"
+
+CC=gcc
+CFLAGS_FULL="$INCLUDE $DEFINES $WARNINGS $CFLAGS $LIBRARIES"
+
+echo "[$0] build: compilation" >&2
+$CC -o bench-bin bench/src/main.c $CFLAGS_FULL
+if [ $? -ne 0 ]
+then
+	echo "[$0] build: failed to compile!" >&2
+	exit 1
+fi
+
+echo "[$0] build: finished successfully" >&2
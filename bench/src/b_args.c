@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+b_args_t b_args =
+{
+	.reps = B_DEFAULTREPS
+};
+
+static void b_usage(char const *name);
+
+void
+b_proc(int argc, char *argv[])
+{
+	int ch;
+	while (ch = getopt(argc, (char *const *)argv, "chm:n:"), ch != -1)
+	{
+		switch (ch)
+		{
+		case 'c':
+			b_args.compact = true;
+			break;
+		case 'h':
+			b_usage(argv[0]);
+			exit(0);
+		case 'm':
+			if (b_args.npaths >= B_MAXPATHS)
+			{
+				fprintf(stderr, "args: cannot have more than %d module paths!\n", B_MAXPATHS);
+				exit(1);
+			}
+			b_args.paths[b_args.npaths++] = optarg;
+			break;
+		case 'n':
+		{
+			char *end;
+			errno = 0;
+			long reps = strtol(optarg, &end, 10);
+			if (errno || end == optarg || *end || reps <= 0 || reps > UINT32_MAX)
+			{
+				fprintf(stderr, "args: invalid repetition count - %s!\n", optarg);
+				exit(1);
+			}
+			b_args.reps = reps;
+			break;
+		}
+		default:
+			exit(1);
+		}
+	}
+	
+	b_args.files = &argv[optind];
+	b_args.nfiles = argc - optind;
+}
+
+static void
+b_usage(char const *name)
+{
+	printf(
+		"bench - benchmark harness for libsatsu\n"
+		"\n"
+		"Usage:\n"
+		"\t%s [options] [file...]\n"
+		"\n"
+		"Options:\n"
+		"\t-c        Compact ASTs after parsing\n"
+		"\t-h        Display help information\n"
+		"\t-m dir    Register import path\n"
+		"\t-n reps   Repetitions per source (default %d)\n"
+		"\n"
+		"Generated sources are always benchmarked, followed by the given\n"
+		"files. Every stage reports the best time over all repetitions.\n",
+		name,
+		B_DEFAULTREPS
+	);
+}
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define B_MAXPATHS 32
+#define B_DEFAULTREPS 5
+
+typedef struct b_args
+{
+	char const *paths[B_MAXPATHS];
+	size_t npaths;
+	char **files;
+	size_t nfiles;
+	uint32_t reps;
+	bool compact;
+} b_args_t;
+
+extern b_args_t b_args;
+
+void b_proc(int argc, char *argv[]);
@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+char const *b_stagenames[B_STAGE_END] =
+{
+	"lex",
+	"parse",
+	"import",
+	"sema",
+	"exec"
+};
+
+static uint64_t b_nallocs;
+
+static uint64_t b_now(void);
+static bool b_runonce(char const *name, uint64_t id, char const *data, uint32_t len, b_result_t *out);
+static void *b_malloc(size_t n);
+static void *b_realloc(void *p, size_t n);
+static void *b_calloc(size_t n, size_t size);
+static void *b_reallocarray(void *p, size_t n, size_t size);
+static char *b_strdup(char const *s);
+static void b_cwrite(char const *buf, size_t len);
+static int64_t b_cread(char *buf, size_t cap);
+
+// allocations are counted through the library's memory hooks, and script
+// console output is discarded so that terminal speed does not skew results.
+void
+b_installhooks(void)
+{
+	ls_malloc = b_malloc;
+	ls_realloc = b_realloc;
+	ls_calloc = b_calloc;
+	ls_reallocarray = b_reallocarray;
+	ls_strdup = b_strdup;
+	
+	ls_conf = (ls_conf_t)
+	{
+		.cread = b_cread,
+		.cwrite = b_cwrite,
+		.compactast = b_args.compact
+	};
+}
+
+// runs the whole pipeline on the source b_args.reps times, keeping the best time
+// of every stage.
+bool
+b_run(char const *name, uint64_t id, char const *data, uint32_t len, b_result_t *out)
+{
+	*out = (b_result_t){0};
+	
+	for (uint32_t i = 0; i < b_args.reps; ++i)
+	{
+		b_result_t r;
+		if (!b_runonce(name, id, data, len, &r))
+		{
+			return false;
+		}
+		
+		for (size_t j = 0; j < B_STAGE_END; ++j)
+		{
+			out->ns[j] = !i || r.ns[j] < out->ns[j] ? r.ns[j] : out->ns[j];
+			out->allocs[j] = r.allocs[j];
+		}
+		
+		out->ntoks = r.ntoks;
+		out->nnodes = r.nnodes;
+		out->nallnodes = r.nallnodes;
+	}
+	
+	return true;
+}
+
+void
+b_printheader(void)
+{
+	printf("%-32s %-8s %14s %20s %12s\n", "source", "stage", "ns/op", "rate", "allocs");
+}
+
+void
+b_report(char const *name, b_result_t const *r)
+{
+	for (size_t i = 0; i < B_STAGE_END; ++i)
+	{
+		double secs = r->ns[i] ? r->ns[i] / 1e9 : 1e-9;
+		
+		char rate[64] = "-";
+		if (i == B_LEX)
+		{
+			snprintf(rate, sizeof(rate), "%.2fM tok/s", r->ntoks / secs / 1e6);
+		}
+		else if (i == B_PARSE)
+		{
+			snprintf(rate, sizeof(rate), "%.2fM node/s", r->nnodes / secs / 1e6);
+		}
+		else if (i == B_IMPORT || i == B_SEMA)
+		{
+			snprintf(rate, sizeof(rate), "%.2fM node/s", r->nallnodes / secs / 1e6);
+		}
+		
+		printf("%-32s %-8s %14" PRIu64 " %20s %12" PRIu64 "\n", name, b_stagenames[i], r->ns[i], rate, r->allocs[i]);
+	}
+}
+
+static uint64_t
+b_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static bool
+b_runonce(char const *name, uint64_t id, char const *data, uint32_t len, b_result_t *out)
+{
+	*out = (b_result_t){0};
+	
+	// the module takes ownership of its data.
+	char *copy = malloc(len + 1);
+	memcpy(copy, data, len);
+	
+	ls_lex_t lex;
+	b_nallocs = 0;
+	uint64_t begin = b_now();
+	ls_err_t e = ls_lex(&lex, copy, len);
+	out->ns[B_LEX] = b_now() - begin;
+	out->allocs[B_LEX] = b_nallocs;
+	if (e.code)
+	{
+		fprintf(stderr, "bench: %s: lex failed - %s!\n", name, e.msg);
+		ls_destroyerr(&e);
+		free(copy);
+		return false;
+	}
+	out->ntoks = lex.ntoks;
+	
+	ls_ast_t ast;
+	b_nallocs = 0;
+	begin = b_now();
+	e = ls_parse(&ast, &lex);
+	out->ns[B_PARSE] = b_now() - begin;
+	out->allocs[B_PARSE] = b_nallocs;
+	if (e.code)
+	{
+		fprintf(stderr, "bench: %s: parse failed - %s!\n", name, e.msg);
+		ls_destroyerr(&e);
+		ls_destroylex(&lex);
+		free(copy);
+		return false;
+	}
+	out->nnodes = ast.nnodes;
+	
+	ls_module_t mod = ls_createmodule(&ast, &lex, strdup(name), id, copy, len);
+	
+	b_nallocs = 0;
+	begin = b_now();
+	e = ls_resolveimports(&mod, b_args.paths, b_args.npaths);
+	out->ns[B_IMPORT] = b_now() - begin;
+	out->allocs[B_IMPORT] = b_nallocs;
+	if (e.code)
+	{
+		fprintf(stderr, "bench: %s: import resolution failed - %s!\n", name, e.msg);
+		ls_destroyerr(&e);
+		ls_destroymodule(&mod);
+		return false;
+	}
+	
+	for (uint32_t i = 0; i < mod.nmods; ++i)
+	{
+		out->nallnodes += mod.asts[i].nnodes;
+	}
+	
+	b_nallocs = 0;
+	begin = b_now();
+	e = ls_sema(&mod);
+	out->ns[B_SEMA] = b_now() - begin;
+	out->allocs[B_SEMA] = b_nallocs;
+	if (e.code)
+	{
+		fprintf(stderr, "bench: %s: semantic analysis failed - %s!\n", name, e.msg);
+		ls_destroyerr(&e);
+		ls_destroymodule(&mod);
+		return false;
+	}
+	
+	ls_sysfns_t sysfns = ls_basesysfns();
+	
+	b_nallocs = 0;
+	begin = b_now();
+	e = ls_exec(&mod, stderr, &sysfns, "start");
+	out->ns[B_EXEC] = b_now() - begin;
+	out->allocs[B_EXEC] = b_nallocs;
+	if (e.code)
+	{
+		fprintf(stderr, "bench: %s: execution failed - %s!\n", name, e.msg);
+		ls_destroyerr(&e);
+		ls_destroysysfns(&sysfns);
+		ls_destroymodule(&mod);
+		return false;
+	}
+	
+	ls_destroysysfns(&sysfns);
+	ls_destroymodule(&mod);
+	return true;
+}
+
+static void *
+b_malloc(size_t n)
+{
+	++b_nallocs;
+	return malloc(n);
+}
+
+static void *
+b_realloc(void *p, size_t n)
+{
+	++b_nallocs;
+	return realloc(p, n);
+}
+
+static void *
+b_calloc(size_t n, size_t size)
+{
+	++b_nallocs;
+	return calloc(n, size);
+}
+
+static void *
+b_reallocarray(void *p, size_t n, size_t size)
+{
+	++b_nallocs;
+	return reallocarray(p, n, size);
+}
+
+static char *
+b_strdup(char const *s)
+{
+	++b_nallocs;
+	return strdup(s);
+}
+
+static void
+b_cwrite(char const *buf, size_t len)
+{
+	(void)buf;
+	(void)len;
+}
+
+static int64_t
+b_cread(char *buf, size_t cap)
+{
+	(void)buf;
+	(void)cap;
+	return 0;
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+typedef enum b_stage
+{
+	B_LEX = 0,
+	B_PARSE,
+	B_IMPORT,
+	B_SEMA,
+	B_EXEC,
+	
+	B_STAGE_END
+} b_stage_t;
+
+typedef struct b_result
+{
+	// best time and allocator calls of each stage.
+	uint64_t ns[B_STAGE_END];
+	uint64_t allocs[B_STAGE_END];
+	
+	// work done, for computing rates.
+	uint64_t ntoks, nnodes, nallnodes;
+} b_result_t;
+
+extern char const *b_stagenames[B_STAGE_END];
+
+void b_installhooks(void);
+bool b_run(char const *name, uint64_t id, char const *data, uint32_t len, b_result_t *out);
+void b_printheader(void);
+void b_report(char const *name, b_result_t const *r);
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+static void b_append(char **data, uint32_t *len, uint32_t *cap, char const *fmt, ...);
+
+// generates a self-contained source of nfuncs small functions, each with a
+// loop, arithmetic and string building, all called once from start(). the
+// output is the same every time, so that results are comparable.
+char *
+b_genlarge(uint32_t nfuncs, uint32_t *outlen)
+{
+	uint32_t len = 0, cap = 1;
+	char *data = calloc(1, 1);
+	
+	for (uint32_t i = 0; i < nfuncs; ++i)
+	{
+		b_append(
+			&data,
+			&len,
+			&cap,
+			"func int\n"
+			"gen%u(int n)\n"
+			"{\n"
+			"\tnew int acc = %u;\n"
+			"\tnew string s = \"\";\n"
+			"\tfor (new int i = 0; i < n; i += 1)\n"
+			"\t{\n"
+			"\t\tacc += i * %u %% 13;\n"
+			"\t\tif (acc > 1000)\n"
+			"\t\t{\n"
+			"\t\t\tacc -= 1000;\n"
+			"\t\t}\n"
+			"\t\ts += (acc => string);\n"
+			"\t}\n"
+			"\treturn acc;\n"
+			"}\n"
+			"\n",
+			i,
+			i,
+			i % 7 + 1
+		);
+	}
+	
+	b_append(&data, &len, &cap, "func void\nstart()\n{\n\tnew int total = 0;\n");
+	for (uint32_t i = 0; i < nfuncs; ++i)
+	{
+		b_append(&data, &len, &cap, "\ttotal += gen%u(4);\n", i);
+	}
+	b_append(&data, &len, &cap, "\tsystem void cprint((total => string) + \"\\n\");\n}\n");
+	
+	*outlen = len;
+	return data;
+}
+
+static void
+b_append(char **data, uint32_t *len, uint32_t *cap, char const *fmt, ...)
+{
+	va_list args;
+	
+	va_start(args, fmt);
+	int n = vsnprintf(NULL, 0, fmt, args);
+	va_end(args);
+	
+	while (*len + n + 1 > *cap)
+	{
+		*cap *= 2;
+		*data = realloc(*data, *cap);
+	}
+	
+	va_start(args, fmt);
+	vsnprintf(&(*data)[*len], n + 1, fmt, args);
+	va_end(args);
+	
+	*len += n;
+}
@@ -0,0 +1,3 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+char *b_genlarge(uint32_t nfuncs, uint32_t *outlen);
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+// standard library.
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+// system dependencies.
+#include <satsu.h>
+#include <unistd.h>
+
+// project headers.
+#include "b_args.h"
+#include "b_bench.h"
+#include "b_gen.h"
+
+// project source.
+#include "b_args.c"
+#include "b_bench.c"
+#include "b_gen.c"
+
+int
+main(int argc, char *argv[])
+{
+	b_proc(argc, argv);
+	b_installhooks();
+	b_printheader();
+	
+	int rc = 0;
+	
+	// generated sources measure front-end throughput at scale.
+	uint32_t const gensizes[] = {500, 2000};
+	for (size_t i = 0; i < sizeof(gensizes) / sizeof(gensizes[0]); ++i)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "gen-%u", gensizes[i]);
+		
+		uint32_t len;
+		char *data = b_genlarge(gensizes[i], &len);
+		
+		b_result_t r;
+		if (b_run(name, 0, data, len, &r))
+		{
+			b_report(name, &r);
+		}
+		else
+		{
+			rc = 1;
+		}
+		
+		free(data);
+	}
+	
+	for (size_t i = 0; i < b_args.nfiles; ++i)
+	{
+		FILE *fp = fopen(b_args.files[i], "rb");
+		if (!fp)
+		{
+			fprintf(stderr, "bench: failed to open file %s!\n", b_args.files[i]);
+			rc = 1;
+			continue;
+		}
+		
+		char *data;
+		uint32_t len;
+		ls_err_t e = ls_readfile(fp, &data, &len);
+		fclose(fp);
+		if (e.code)
+		{
+			fprintf(stderr, "bench: failed to read file %s - %s!\n", b_args.files[i], e.msg);
+			ls_destroyerr(&e);
+			rc = 1;
+			continue;
+		}
+		
+		b_result_t r;
+		if (b_run(b_args.files[i], ls_fileid(b_args.files[i], true), data, len, &r))
+		{
+			b_report(b_args.files[i], &r);
+		}
+		else
+		{
+			rc = 1;
+		}
+		
+		free(data);
+	}
+	
+	return rc;
+}
@@ -8,10 +8,16 @@ void
 a_proc(i32 argc, char *argv[])
 {
 	i32 ch;
-	while (ch = getopt(argc, (char *const *)argv, "hm:t:"), ch != -1)
+	while (ch = getopt(argc, (char *const *)argv, "achm:p:st:T:x"), ch != -1)
 	{
 		switch (ch)
 		{
+		case 'a':
+			a_args.arena = true;
+			break;
+		case 'c':
+			a_args.compact = true;
+			break;
 		case 'h':
 			a_usage(argv[0]);
 			exit(0);
@@ -28,6 +34,12 @@ a_proc(i32 argc, char *argv[])
 			}
 			a_args.paths[a_args.npaths++] = optarg;
 			break;
+		case 'p':
+			a_args.proffile = optarg;
+			break;
+		case 's':
+			a_args.memstats = true;
+			break;
 		case 't':
 			if (!strcmp(optarg, "exec"))
 			{
@@ -55,6 +67,22 @@ a_proc(i32 argc, char *argv[])
 				exit(1);
 			}
 			break;
+		case 'T':
+		{
+			char *end;
+			errno = 0;
+			long timeout = strtol(optarg, &end, 10);
+			if (errno || end == optarg || *end || timeout <= 0 || timeout > UINT_MAX)
+			{
+				err("args: invalid timeout - %s!", optarg);
+				exit(1);
+			}
+			a_args.timeout = timeout;
+			break;
+		}
+		case 'x':
+			a_args.trace = true;
+			break;
 		default:
 			exit(1);
 		}
@@ -85,9 +113,15 @@ a_usage(char const *name)
 		"\t%s [options] file\n"
 		"\n"
 		"Options:\n"
+		"\t-a        Allocate script strings from an arena\n"
+		"\t-c        Compact ASTs after parsing\n"
 		"\t-h        Display help information\n"
 		"\t-m dir    Register import path\n"
+		"\t-p file   Profile execution, writing collapsed stacks to file\n"
+		"\t-s        Dump memory statistics after execution\n"
 		"\t-t stage  Terminate execution at an early stage\n"
+		"\t-T secs   Stop execution after a number of seconds\n"
+		"\t-x        Trace execution and show a per-line heat map\n"
 		"\n"
 		"Legal stages:\n"
 		"\texec      Run the file (default)\n"
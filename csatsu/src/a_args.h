@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #define A_MAXPATHS 32
+#define A_PROFHZ 1000
 
 typedef enum a_target
 {
@@ -14,10 +15,16 @@ typedef enum a_target
 typedef struct a_args
 {
 	char const *infile;
+	char const *proffile;
 	FILE *infp;
 	char const *paths[A_MAXPATHS];
 	usize npaths;
 	u8 target;
+	bool arena;
+	bool compact;
+	bool memstats;
+	bool trace;
+	u32 timeout;
 } a_args_t;
 
 extern a_args_t a_args;
@@ -1,5 +1,9 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
+ls_cancel_t e_cancel;
+
+static void e_timeout(int sig);
+
 int
 e_cget(void)
 {
@@ -12,3 +16,45 @@ e_cput(int c)
 {
 	fputc(c, stdout);
 }
+
+i64
+e_cread(char *buf, usize cap)
+{
+	// anything written so far might be a prompt for this input.
+	fflush(stdout);
+	
+	// an interrupted read gives the execution a chance to be cancelled.
+	ssize_t n = read(STDIN_FILENO, buf, cap);
+	if (n < 0 && errno == EINTR)
+	{
+		return LS_CIGNORE;
+	}
+	return n < 0 ? LS_CERR : n;
+}
+
+void
+e_cwrite(char const *buf, usize len)
+{
+	fwrite(buf, 1, len, stdout);
+}
+
+// raises e_cancel after the given number of seconds of real time. SIGALRM does
+// not restart system calls, so a script blocked on console input is woken up.
+void
+e_starttimeout(u32 secs)
+{
+	struct sigaction action =
+	{
+		.sa_handler = e_timeout
+	};
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGALRM, &action, NULL);
+	alarm(secs);
+}
+
+static void
+e_timeout(int sig)
+{
+	(void)sig;
+	e_cancel.raised = 1;
+}
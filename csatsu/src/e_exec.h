@@ -1,4 +1,9 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
+extern ls_cancel_t e_cancel;
+
 int e_cget(void);
 void e_cput(int c);
+i64 e_cread(char *buf, usize cap);
+void e_cwrite(char const *buf, usize len);
+void e_starttimeout(u32 secs);
@@ -1,6 +1,10 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 // standard library.
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -32,7 +36,13 @@ main(int argc, char *argv[])
 	ls_conf = (ls_conf_t)
 	{
 		.cget = e_cget,
-		.cput = e_cput
+		.cput = e_cput,
+		.cread = e_cread,
+		.cwrite = e_cwrite,
+		.clinebuf = isatty(STDOUT_FILENO),
+		.execarena = a_args.arena,
+		.compactast = a_args.compact,
+		.memstats = a_args.memstats
 	};
 	
 	char *filedata;
@@ -128,7 +138,8 @@ main(int argc, char *argv[])
 	
 	ls_sysfns_t sysfns = ls_basesysfns();
 	
-	e = ls_exec(&mod, stderr, &sysfns, "start");
+	struct ls_exec *exec;
+	e = ls_createexec(&exec, &mod, stderr, &sysfns, "start");
 	if (e.code)
 	{
 		err("main: execution failed - %s!", e.msg);
@@ -138,7 +149,84 @@ main(int argc, char *argv[])
 		return 1;
 	}
 	
+	ls_profile_t prof = ls_createprofile();
+	if (a_args.proffile)
+	{
+		ls_startprofile(exec, &prof, A_PROFHZ);
+	}
+	
+	ls_trace_t trace = ls_createtrace(&mod);
+	if (a_args.trace)
+	{
+		ls_setexectrace(exec, &trace);
+	}
+	
+	if (a_args.timeout)
+	{
+		ls_setexeccancel(exec, &e_cancel);
+		e_starttimeout(a_args.timeout);
+	}
+	
+	ls_execstatus_t status = ls_resumeexec(exec, 0);
+	if (status == LS_EXECCANCELLED)
+	{
+		err("main: execution timed out after %u seconds!", a_args.timeout);
+	}
+	
+	if (a_args.proffile)
+	{
+		ls_stopprofile(exec);
+	}
+	ls_destroyexec(exec);
+	
+	if (a_args.proffile)
+	{
+		FILE *fp = fopen(a_args.proffile, "wb");
+		if (fp)
+		{
+			ls_printprofstacks(fp, &prof, &mod);
+			fclose(fp);
+		}
+		else
+		{
+			err("main: failed to open profile file for writing - %s!", a_args.proffile);
+		}
+		ls_printproftable(stderr, &prof, &mod);
+	}
+	ls_destroyprofile(&prof);
+	
+	if (a_args.trace)
+	{
+		for (u32 i = 0; i < mod.nmods; ++i)
+		{
+			u64 *counts = calloc(mod.lens[i] + 1, sizeof(u64));
+			u64 *times = calloc(mod.lens[i] + 1, sizeof(u64));
+			ls_tracelines(&trace, &mod, i, counts, times);
+			
+			// modules which never ran are left out.
+			bool ran = false;
+			for (u32 j = 0; j <= mod.lens[i] && !ran; ++j)
+			{
+				ran = counts[j];
+			}
+			
+			if (ran)
+			{
+				showheat(stderr, mod.names[i], mod.data[i], mod.lens[i], counts, times);
+			}
+			free(counts);
+			free(times);
+		}
+	}
+	ls_destroytrace(&trace);
+	
+	if (a_args.memstats)
+	{
+		ls_memstats_t ms = ls_memstats();
+		ls_printmemstats(stderr, &ms);
+	}
+	
 	ls_destroysysfns(&sysfns);
 	ls_destroymodule(&mod);
-	return 0;
+	return status == LS_EXECCANCELLED;
 }
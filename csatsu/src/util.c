@@ -108,6 +108,70 @@ showfile(
 	fprintf(fp, "\x1b[0m\n");
 }
 
+// shows every line of the file next to its execution count and time, colored
+// by its share of the hottest line's time.
+void
+showheat(
+	FILE *fp,
+	char const *name,
+	char const *data,
+	usize datalen,
+	u64 const *counts,
+	u64 const *times
+)
+{
+	u32 nlines = 1;
+	for (usize i = 0; i < datalen; ++i)
+	{
+		nlines += data[i] == '\n';
+	}
+	
+	u64 maxtime = 1;
+	for (u32 i = 0; i < nlines; ++i)
+	{
+		maxtime = times[i] > maxtime ? times[i] : maxtime;
+	}
+	
+	char linum[32] = {0};
+	sprintf(linum, "%u", nlines);
+	int linumlen = strlen(linum);
+	
+	fprintf(fp, "%s:\n", name);
+	
+	usize lbegin = 0;
+	for (u32 line = 0; line < nlines; ++line)
+	{
+		usize lend = lbegin;
+		while (lend < datalen && data[lend] != '\n')
+		{
+			++lend;
+		}
+		
+		char const *color = "\x1b[2m";
+		if (counts[line])
+		{
+			u64 heat = 100 * times[line] / maxtime;
+			color = heat >= 50 ? "\x1b[1;31m" : heat >= 10 ? "\x1b[1;33m" : "\x1b[32m";
+		}
+		
+		fprintf(fp, " %*u | %12" PRIu64 " %10.3fms | %s", linumlen, line + 1, counts[line], times[line] / 1e6, color);
+		for (usize i = lbegin; i < lend; ++i)
+		{
+			if (data[i] == '\t')
+			{
+				fprintf(fp, "  ");
+			}
+			else
+			{
+				fprintf(fp, "%c", data[i]);
+			}
+		}
+		fprintf(fp, "\x1b[0m\n");
+		
+		lbegin = lend + 1;
+	}
+}
+
 FILE *
 openread(char const *file)
 {
@@ -22,4 +22,5 @@ typedef double f64;
 void err(char const *fmt, ...);
 void errfile(char const *name, char const *data, usize datalen, usize pos, usize len, char const *fmt, ...);
 void showfile(FILE *fp, char const *name, char const *data, usize datalen, usize pos, usize len);
+void showheat(FILE *fp, char const *name, char const *data, usize datalen, u64 const *counts, u64 const *times);
 FILE *openread(char const *file);
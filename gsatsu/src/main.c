@@ -7,10 +7,13 @@
 #include <time.h>
 
 // system dependencies.
+#include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 // in-project dependencies.
 #include <satsu.h>
@@ -47,7 +50,10 @@ main(int argc, char *argv[])
 	ls_conf = (ls_conf_t)
 	{
 		.cget = p_cget,
-		.cput = p_cput
+		.cput = p_cput,
+		.cread = p_cread,
+		.cwrite = p_cwrite,
+		.clinebuf = true
 	};
 	
 	if (SDL_Init(O_SDLFLAGS))
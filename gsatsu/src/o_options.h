@@ -12,12 +12,22 @@
 // system options.
 #define O_TICKMS 20
 #define O_TICKUS (1000 * O_TICKMS)
+#define O_IDLEMS 500
+#define O_CGETWAITMS 100
 #define O_MAXLOGLEN 512
 #define O_MAXUIELEMS 128
 #define O_MAXMODPATHS 7
 #define O_NOUTPUTLINES 26
+#define O_SCROLLCHUNKLINES 1024
+#define O_NSCROLLCHUNKS 128
+#define O_SCROLLSTEP 3
 #define O_MAXIOLINE 55
 #define O_MAXINPUT 128
+#define O_OUTRINGSIZE (64 * 1024)
+#define O_FILEBUFSIZE (1024 * 1024)
+#define O_FSYNCMS 1000
+#define O_MAXCACHEDTEXTS 256
+#define O_TEXTCACHEBYTES (8 * 1024 * 1024)
 
 // stylistic options.
 #define O_FONTSIZE 22
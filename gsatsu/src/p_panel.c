@@ -17,7 +17,11 @@ p_panel_t p_panel =
 		.buf = p_panel.inputline,
 		.cap = sizeof(p_panel.inputline)
 	},
-	.cgetmutex = PTHREAD_MUTEX_INITIALIZER
+	.cgetmutex = PTHREAD_MUTEX_INITIALIZER,
+	.cgetcond = PTHREAD_COND_INITIALIZER,
+	.filemutex = PTHREAD_MUTEX_INITIALIZER,
+	.filecond = PTHREAD_COND_INITIALIZER,
+	.filespacecond = PTHREAD_COND_INITIALIZER
 };
 
 static void p_lex(void);
@@ -26,6 +30,12 @@ static void p_import(void);
 static void p_sema(void);
 static void p_exec(void);
 static void *p_execmodule(void *vpmod);
+static void p_appendoutput(char const *buf, usize len);
+static void p_writering(char const *buf, usize len);
+static bool p_waitinput(void);
+static void p_deadline(struct timespec *ts, u32 ms);
+static void p_writefile(char const *buf, usize len);
+static void *p_filewriter(void *arg);
 
 void
 p_run(void)
@@ -39,20 +49,55 @@ p_run(void)
 		};
 	}
 	
+	p_panel.uithread = pthread_self();
+	p_panel.redrawevent = SDL_RegisterEvents(1);
+	if (p_panel.redrawevent == (u32)-1)
+	{
+		z_err("panel: failed to register redraw event!");
+		return;
+	}
+	
+	bool wasrunning = false;
 	for (;;)
 	{
-		z_begintick();
-		
-		// handle events.
+		// block until there is input or a redraw notification, so that an idle
+		// window uses no CPU.
 		z_prepareinput();
 		SDL_Event e;
-		while (SDL_PollEvent(&e))
+		bool redraw = false;
+		if (SDL_WaitEventTimeout(&e, O_IDLEMS))
 		{
-			z_handleinput(&e);
-			if (e.type == SDL_QUIT)
+			do
 			{
-				return;
-			}
+				if (e.type == SDL_QUIT)
+				{
+					return;
+				}
+				
+				if (e.type == p_panel.redrawevent)
+				{
+					SDL_AtomicSet(&p_panel.redrawpending, 0);
+				}
+				else if (e.type == SDL_MOUSEWHEEL)
+				{
+					p_scroll(e.wheel.y * O_SCROLLSTEP);
+				}
+				
+				z_handleinput(&e);
+				redraw = true;
+			} while (SDL_PollEvent(&e));
+		}
+		
+		z_begintick();
+		p_drainoutput();
+		
+		if (z_kpressed(SDLK_PAGEUP))
+		{
+			p_scroll(O_NOUTPUTLINES);
+		}
+		if (z_kpressed(SDLK_PAGEDOWN))
+		{
+			p_scroll(-O_NOUTPUTLINES);
 		}
 		
 		// do main UI panel.
@@ -131,9 +176,12 @@ p_run(void)
 		
 		z_uilabel(&io, "Input / output terminal");
 		z_uipad(&io, 0, 20);
-		for (i32 i = O_NOUTPUTLINES - 1; i >= 0; --i)
+		
+		// only the visible window of the scrollback is laid out.
+		i64 bottom = p_panel.scrollnext - p_panel.scrolloff;
+		for (i64 i = bottom - O_NOUTPUTLINES; i < bottom; ++i)
 		{
-			z_uilabel(&io, p_panel.outputlines[i]);
+			z_uilabel(&io, i >= 0 ? p_outputline(i) : "");
 		}
 		z_uiactive(&io, p_panel.running);
 		z_uipad(&io, 0, 20);
@@ -154,8 +202,20 @@ p_run(void)
 				.cap = sizeof(p_panel.inputline)
 			};
 			
+			pthread_cond_signal(&p_panel.cgetcond);
 			pthread_mutex_unlock(&p_panel.cgetmutex);
 		}
+		if (z_uibutton(&io, "Stop"))
+		{
+			p_panel.cancel.raised = 1;
+		}
+		
+		redraw = redraw || p_panel.running != wasrunning;
+		wasrunning = p_panel.running;
+		if (!redraw)
+		{
+			continue;
+		}
 		
 		// render.
 		SDL_SetRenderDrawColor(r_rend, O_BGCOLOR);
@@ -165,6 +225,8 @@ p_run(void)
 		z_renderui(&io);
 		SDL_RenderPresent(r_rend);
 		
+		// redraws are still capped to one per tick, which coalesces output
+		// bursts into a single frame.
 		z_endtick();
 	}
 }
@@ -172,26 +234,161 @@ p_run(void)
 void
 p_clearoutput(void)
 {
-	for (usize i = 0; i < O_NOUTPUTLINES; ++i)
-	{
-		memset(&p_panel.outputlines[i], 0, sizeof(p_panel.outputlines[i]));
-	}
+	// chunks are kept allocated for reuse.
+	p_panel.scrollfirst = p_panel.scrollnext;
+	p_panel.scrolloff = 0;
 }
 
 void
 p_pushoutput(char const *line)
 {
-	memmove(
-		&p_panel.outputlines[1],
-		&p_panel.outputlines[0],
-		sizeof(p_panel.outputlines[0]) * (O_NOUTPUTLINES - 1)
-	);
+	u64 chunk = p_panel.scrollnext / O_SCROLLCHUNKLINES % O_NSCROLLCHUNKS;
+	u64 idx = p_panel.scrollnext % O_SCROLLCHUNKLINES;
+	
+	// the chunk being started may hold the oldest lines, which are dropped. the
+	// first line is not always at the start of a chunk, since clearing output
+	// just moves it on.
+	u64 keep = (O_NSCROLLCHUNKS - 1) * O_SCROLLCHUNKLINES;
+	if (!idx && p_panel.scrollnext - p_panel.scrollfirst > keep)
+	{
+		p_panel.scrollfirst = p_panel.scrollnext - keep;
+		p_scroll(0);
+	}
+	
+	if (!p_panel.scrollchunks[chunk])
+	{
+		p_panel.scrollchunks[chunk] = calloc(O_SCROLLCHUNKLINES, O_MAXIOLINE + 1);
+	}
 	
-	memset(&p_panel.outputlines[0], 0, sizeof(p_panel.outputlines[0]));
+	char *dst = p_panel.scrollchunks[chunk][idx];
+	memset(dst, 0, O_MAXIOLINE + 1);
 	for (usize i = 0; i < O_MAXIOLINE && line[i]; ++i)
 	{
-		p_panel.outputlines[0][i] = line[i];
+		dst[i] = line[i];
+	}
+	
+	++p_panel.scrollnext;
+	
+	// a scrolled view stays on the lines being read.
+	if (p_panel.scrolloff)
+	{
+		p_scroll(1);
+	}
+}
+
+char const *
+p_outputline(u64 line)
+{
+	if (line < p_panel.scrollfirst || line >= p_panel.scrollnext)
+	{
+		return "";
 	}
+	
+	u64 chunk = line / O_SCROLLCHUNKLINES % O_NSCROLLCHUNKS;
+	return p_panel.scrollchunks[chunk][line % O_SCROLLCHUNKLINES];
+}
+
+// positive line counts scroll towards older output.
+void
+p_scroll(i64 nlines)
+{
+	u64 nstored = p_panel.scrollnext - p_panel.scrollfirst;
+	i64 maxoff = nstored > O_NOUTPUTLINES ? nstored - O_NOUTPUTLINES : 0;
+	
+	i64 off = p_panel.scrolloff + nlines;
+	off = off < 0 ? 0 : off;
+	off = off > maxoff ? maxoff : off;
+	p_panel.scrolloff = off;
+}
+
+// wakes the UI thread to redraw. only one notification is queued at a time, no
+// matter how often this is called before the UI thread handles it.
+void
+p_notify(void)
+{
+	if (SDL_AtomicSet(&p_panel.redrawpending, 1))
+	{
+		return;
+	}
+	
+	SDL_Event e =
+	{
+		.type = p_panel.redrawevent
+	};
+	SDL_PushEvent(&e);
+}
+
+// moves all output written by the script thread into the output lines. must only
+// be called from the UI thread.
+void
+p_drainoutput(void)
+{
+	// the flag is taken before draining, so that all output written before it
+	// was raised is drained first.
+	bool flush = SDL_AtomicSet(&p_panel.outflush, 0);
+	
+	u32 tail = SDL_AtomicGet(&p_panel.outtail);
+	u32 head = SDL_AtomicGet(&p_panel.outhead);
+	while (tail != head)
+	{
+		u32 idx = tail & (O_OUTRINGSIZE - 1);
+		u32 n = head - tail < O_OUTRINGSIZE - idx ? head - tail : O_OUTRINGSIZE - idx;
+		p_appendoutput(&p_panel.outring[idx], n);
+		tail += n;
+	}
+	SDL_AtomicSet(&p_panel.outtail, tail);
+	
+	if (flush && p_panel.cputlen)
+	{
+		p_panel.cputbuf[p_panel.cputlen] = 0;
+		p_panel.cputlen = 0;
+		p_pushoutput(p_panel.cputbuf);
+	}
+}
+
+// starts copying console output to the output file, until p_closeoutputfile() is
+// called.
+i32
+p_openoutputfile(void)
+{
+	i32 fd = open(p_panel.outputfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1)
+	{
+		return 1;
+	}
+	
+	p_panel.filebuf = malloc(O_FILEBUFSIZE);
+	p_panel.filelen = 0;
+	p_panel.filefd = fd;
+	p_panel.fileactive = true;
+	
+	if (pthread_create(&p_panel.filethread, NULL, p_filewriter, NULL))
+	{
+		p_panel.fileactive = false;
+		free(p_panel.filebuf);
+		close(fd);
+		return 1;
+	}
+	
+	return 0;
+}
+
+// waits for all copied output to be written and synced, then closes the file.
+void
+p_closeoutputfile(void)
+{
+	pthread_mutex_lock(&p_panel.filemutex);
+	if (!p_panel.fileactive)
+	{
+		pthread_mutex_unlock(&p_panel.filemutex);
+		return;
+	}
+	p_panel.fileactive = false;
+	pthread_cond_signal(&p_panel.filecond);
+	pthread_mutex_unlock(&p_panel.filemutex);
+	
+	pthread_join(p_panel.filethread, NULL);
+	free(p_panel.filebuf);
 }
 
 void
@@ -297,15 +494,16 @@ p_cget(void)
 {
 	pthread_mutex_lock(&p_panel.cgetmutex);
 	
-	// may need to first flush cput buffer (otherwise prompts won't be visible).
-	if (p_panel.cputlen)
+	// may need to first flush the partial output line (otherwise prompts won't
+	// be visible).
+	if (p_panel.outpartial)
 	{
-		p_panel.cputbuf[p_panel.cputlen] = 0;
-		p_panel.cputlen = 0;
-		ls_cprintf("%s\n", p_panel.cputbuf);
+		p_panel.outpartial = false;
+		SDL_AtomicSet(&p_panel.outflush, 1);
+		p_notify();
 	}
 	
-	if (!p_panel.cgetlen)
+	if (!p_waitinput())
 	{
 		pthread_mutex_unlock(&p_panel.cgetmutex);
 		return LS_CIGNORE;
@@ -327,24 +525,64 @@ p_cget(void)
 void
 p_cput(i32 c)
 {
-	// TODO: also write characters to the output file.
+	char ch = c;
+	p_cwrite(&ch, 1);
+}
+
+i64
+p_cread(char *buf, usize cap)
+{
+	pthread_mutex_lock(&p_panel.cgetmutex);
 	
-	if (c == '\n')
+	// may need to first flush the partial output line (otherwise prompts won't
+	// be visible).
+	if (p_panel.outpartial)
 	{
-		p_panel.cputbuf[p_panel.cputlen] = 0;
-		p_panel.cputlen = 0;
-		p_pushoutput(p_panel.cputbuf);
-		return;
+		p_panel.outpartial = false;
+		SDL_AtomicSet(&p_panel.outflush, 1);
+		p_notify();
 	}
 	
-	if (p_panel.cputlen >= O_MAXIOLINE)
+	if (!p_waitinput())
 	{
-		p_panel.cputbuf[p_panel.cputlen] = 0;
-		p_panel.cputlen = 0;
-		p_pushoutput(p_panel.cputbuf);
+		pthread_mutex_unlock(&p_panel.cgetmutex);
+		return LS_CIGNORE;
+	}
+	
+	usize n = 0;
+	while (n < cap && p_panel.cgetidx < p_panel.cgetlen)
+	{
+		buf[n++] = p_panel.cgetbuf[p_panel.cgetidx++];
+	}
+	
+	// the sent line is terminated once it has been fully read.
+	if (n < cap)
+	{
+		buf[n++] = '\n';
+		p_panel.cgetidx = 0;
+		p_panel.cgetlen = 0;
 	}
 	
-	p_panel.cputbuf[p_panel.cputlen++] = c;
+	pthread_mutex_unlock(&p_panel.cgetmutex);
+	return n;
+}
+
+void
+p_cwrite(char const *buf, usize len)
+{
+	p_writefile(buf, len);
+	
+	// the UI thread owns the output lines, so it appends to them directly once
+	// earlier script output has been drained.
+	if (pthread_equal(pthread_self(), p_panel.uithread))
+	{
+		p_drainoutput();
+		p_appendoutput(buf, len);
+	}
+	else
+	{
+		p_writering(buf, len);
+	}
 }
 
 static void
@@ -686,18 +924,28 @@ p_exec(void)
 		return;
 	}
 	
+	if (p_panel.outputfile[0] && p_openoutputfile())
+	{
+		p_err("exec: failed to open output file %s!", p_panel.outputfile);
+		ls_destroymodule(&mod);
+		return;
+	}
+	
 	ls_module_t *pmod = malloc(sizeof(ls_module_t));
 	*pmod = mod;
 	
 	p_panel.running = true;
+	p_panel.cancel.raised = 0;
 	pthread_t execthread;
 	i32 rc = pthread_create(&execthread, NULL, p_execmodule, pmod);
 	if (rc)
 	{
 		p_err("exec: failed to create execution thread!");
+		p_closeoutputfile();
 		ls_destroyerr(&e);
 		ls_destroymodule(pmod);
 		free(pmod);
+		p_panel.running = false;
 		return;
 	}
 	
@@ -710,8 +958,8 @@ p_execmodule(void *vpmod)
 	ls_module_t *pmod = vpmod;
 	ls_sysfns_t sysfns = ls_basesysfns();
 	
-	ls_err_t e = ls_exec(pmod, stderr, &sysfns, "start");
-	
+	struct ls_exec *exec;
+	ls_err_t e = ls_createexec(&exec, pmod, stderr, &sysfns, "start");
 	if (e.code)
 	{
 		p_err("exec: execution failed - %s!", e.msg);
@@ -719,14 +967,213 @@ p_execmodule(void *vpmod)
 		ls_destroysysfns(&sysfns);
 		ls_destroymodule(pmod);
 		free(pmod);
+		p_closeoutputfile();
 		p_panel.running = false;
+		p_notify();
 		return NULL;
 	}
 	
-	p_pushoutput("exec: finished successfully");
+	ls_setexeccancel(exec, &p_panel.cancel);
+	ls_execstatus_t status = ls_resumeexec(exec, 0);
+	ls_destroyexec(exec);
+	
+	if (status == LS_EXECCANCELLED)
+	{
+		ls_cprintf("exec: stopped\n");
+	}
+	else
+	{
+		ls_cprintf("exec: finished successfully\n");
+	}
 	ls_destroysysfns(&sysfns);
 	ls_destroymodule(pmod);
 	free(pmod);
+	p_closeoutputfile();
 	p_panel.running = false;
+	p_notify();
 	return NULL;
 }
+
+static void
+p_appendoutput(char const *buf, usize len)
+{
+	for (usize i = 0; i < len; ++i)
+	{
+		if (buf[i] == '\n')
+		{
+			p_panel.cputbuf[p_panel.cputlen] = 0;
+			p_panel.cputlen = 0;
+			p_pushoutput(p_panel.cputbuf);
+			continue;
+		}
+		
+		if (p_panel.cputlen >= O_MAXIOLINE)
+		{
+			p_panel.cputbuf[p_panel.cputlen] = 0;
+			p_panel.cputlen = 0;
+			p_pushoutput(p_panel.cputbuf);
+		}
+		
+		p_panel.cputbuf[p_panel.cputlen++] = buf[i];
+	}
+}
+
+// the script thread is the only producer. if the ring is full, it waits for the
+// UI thread to drain it rather than dropping output.
+static void
+p_writering(char const *buf, usize len)
+{
+	if (!len)
+	{
+		return;
+	}
+	
+	for (usize i = 0; i < len;)
+	{
+		u32 head = SDL_AtomicGet(&p_panel.outhead);
+		u32 tail = SDL_AtomicGet(&p_panel.outtail);
+		u32 space = O_OUTRINGSIZE - (head - tail);
+		if (!space)
+		{
+			p_notify();
+			SDL_Delay(1);
+			continue;
+		}
+		
+		usize n = len - i < space ? len - i : space;
+		for (usize j = 0; j < n; ++j)
+		{
+			p_panel.outring[(head + j) & (O_OUTRINGSIZE - 1)] = buf[i + j];
+		}
+		SDL_AtomicSet(&p_panel.outhead, head + n);
+		
+		i += n;
+	}
+	
+	p_panel.outpartial = buf[len - 1] != '\n';
+	p_notify();
+}
+
+// blocks until input is sent, for at most O_CGETWAITMS so that the library gets
+// to run between waits. must be called with cgetmutex held.
+static bool
+p_waitinput(void)
+{
+	struct timespec ts;
+	p_deadline(&ts, O_CGETWAITMS);
+	
+	while (!p_panel.cgetlen)
+	{
+		if (pthread_cond_timedwait(&p_panel.cgetcond, &p_panel.cgetmutex, &ts))
+		{
+			return p_panel.cgetlen;
+		}
+	}
+	
+	return true;
+}
+
+static void
+p_deadline(struct timespec *ts, u32 ms)
+{
+	clock_gettime(CLOCK_REALTIME, ts);
+	ts->tv_nsec += 1000000 * ms;
+	ts->tv_sec += ts->tv_nsec / 1000000000;
+	ts->tv_nsec %= 1000000000;
+}
+
+// copies output into the file buffer. the caller only blocks if the writer
+// thread has fallen a whole buffer behind.
+static void
+p_writefile(char const *buf, usize len)
+{
+	pthread_mutex_lock(&p_panel.filemutex);
+	
+	while (len && p_panel.fileactive)
+	{
+		if (p_panel.filelen >= O_FILEBUFSIZE)
+		{
+			pthread_cond_signal(&p_panel.filecond);
+			pthread_cond_wait(&p_panel.filespacecond, &p_panel.filemutex);
+			continue;
+		}
+		
+		usize n = len < O_FILEBUFSIZE - p_panel.filelen ? len : O_FILEBUFSIZE - p_panel.filelen;
+		memcpy(&p_panel.filebuf[p_panel.filelen], buf, n);
+		p_panel.filelen += n;
+		buf += n;
+		len -= n;
+	}
+	
+	if (p_panel.filelen >= O_FILEBUFSIZE / 2)
+	{
+		pthread_cond_signal(&p_panel.filecond);
+	}
+	
+	pthread_mutex_unlock(&p_panel.filemutex);
+}
+
+// swaps the filled buffer for an empty one and writes it out with the mutex
+// released, syncing at most every O_FSYNCMS and when the file is closed.
+static void *
+p_filewriter(void *arg)
+{
+	(void)arg;
+	
+	char *spare = malloc(O_FILEBUFSIZE);
+	u64 lastsync = z_unixus();
+	
+	pthread_mutex_lock(&p_panel.filemutex);
+	for (;;)
+	{
+		struct timespec ts;
+		p_deadline(&ts, O_FSYNCMS);
+		while (p_panel.fileactive && p_panel.filelen < O_FILEBUFSIZE / 2)
+		{
+			if (pthread_cond_timedwait(&p_panel.filecond, &p_panel.filemutex, &ts))
+			{
+				break;
+			}
+		}
+		
+		char *buf = p_panel.filebuf;
+		usize len = p_panel.filelen;
+		bool closing = !p_panel.fileactive;
+		p_panel.filebuf = spare;
+		p_panel.filelen = 0;
+		spare = buf;
+		pthread_cond_broadcast(&p_panel.filespacecond);
+		pthread_mutex_unlock(&p_panel.filemutex);
+		
+		for (usize off = 0; off < len;)
+		{
+			ssize_t n = write(p_panel.filefd, &buf[off], len - off);
+			if (n == -1 && errno == EINTR)
+			{
+				continue;
+			}
+			else if (n == -1)
+			{
+				// output is dropped rather than stalling the script.
+				break;
+			}
+			off += n;
+		}
+		
+		u64 now = z_unixus();
+		if (closing || now - lastsync >= 1000 * O_FSYNCMS)
+		{
+			fsync(p_panel.filefd);
+			lastsync = now;
+		}
+		
+		if (closing)
+		{
+			close(p_panel.filefd);
+			free(spare);
+			return NULL;
+		}
+		
+		pthread_mutex_lock(&p_panel.filemutex);
+	}
+}
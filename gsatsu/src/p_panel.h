@@ -7,7 +7,6 @@ typedef struct p_panel
 	char outputfile[128];
 	char modpaths[O_MAXMODPATHS][128];
 	char inputline[O_MAXINPUT];
-	char outputlines[O_NOUTPUTLINES][O_MAXIOLINE + 1];
 	
 	// persistent UI elements.
 	z_tfdata_t inputfiletf;
@@ -17,14 +16,44 @@ typedef struct p_panel
 	
 	// cget / cput interface data.
 	pthread_mutex_t cgetmutex;
+	pthread_cond_t cgetcond;
 	char cgetbuf[O_MAXINPUT];
 	char cputbuf[O_MAXIOLINE + 1];
 	usize cgetlen;
 	usize cgetidx;
 	usize cputlen;
 	
+	// scrollback, holding up to O_NSCROLLCHUNKS chunks of lines. lines are
+	// numbered from the start of the program, and the oldest chunk is reused
+	// once all are full.
+	char (*scrollchunks[O_NSCROLLCHUNKS])[O_MAXIOLINE + 1];
+	u64 scrollfirst, scrollnext;
+	u64 scrolloff;
+	
+	// output ring, written by the script thread and drained by the UI thread.
+	// the ring size must be a power of two.
+	pthread_t uithread;
+	char outring[O_OUTRINGSIZE];
+	SDL_atomic_t outhead, outtail, outflush;
+	bool outpartial;
+	
+	// output file data. console output is copied into the buffer, which is
+	// written out by a background thread while a script runs.
+	pthread_t filethread;
+	pthread_mutex_t filemutex;
+	pthread_cond_t filecond, filespacecond;
+	char *filebuf;
+	usize filelen;
+	i32 filefd;
+	bool fileactive;
+	
 	// execution data.
 	bool running;
+	ls_cancel_t cancel;
+	
+	// redraw notification data.
+	u32 redrawevent;
+	SDL_atomic_t redrawpending;
 } p_panel_t;
 
 extern p_panel_t p_panel;
@@ -32,8 +61,16 @@ extern p_panel_t p_panel;
 void p_run(void);
 void p_clearoutput(void);
 void p_pushoutput(char const *line);
+char const *p_outputline(u64 line);
+void p_scroll(i64 nlines);
+void p_notify(void);
+void p_drainoutput(void);
+i32 p_openoutputfile(void);
+void p_closeoutputfile(void);
 void p_err(char const *fmt, ...);
 void p_errfile(char const *name, char const *data, usize datalen, usize pos, usize len, char const *fmt, ...);
 void p_showfile(char const *name, char const *data, usize datalen, usize pos, usize len);
 i32 p_cget(void);
 void p_cput(i32 c);
+i64 p_cread(char *buf, usize cap);
+void p_cwrite(char const *buf, usize len);
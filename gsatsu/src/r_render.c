@@ -3,12 +3,22 @@
 SDL_Window *r_wnd;
 SDL_Renderer *r_rend;
 TTF_Font *r_fonts[R_FONT_END];
+r_atlas_t r_atlases[R_FONT_END];
 
 static resdata_t r_fontres[R_FONT_END] =
 {
 	INCRES(vcr_osd_mono_ttf)
 };
 
+// least recently used textures are evicted to stay under O_TEXTCACHEBYTES.
+static r_cachedtext_t r_textcache[O_MAXCACHEDTEXTS];
+static usize r_ncachedtexts;
+static u64 r_textcachebytes, r_textcacheclock;
+
+static i32 r_buildatlas(r_font_t font);
+static u64 r_hashtext(r_font_t font, char const *text, u32 color);
+static void r_evicttext(void);
+
 i32
 r_init(void)
 {
@@ -49,6 +59,11 @@ r_init(void)
 			z_err("render: failed to open font - %s!", TTF_GetError());
 			return 1;
 		}
+		
+		if (r_buildatlas(i))
+		{
+			return 1;
+		}
 	}
 	
 	// set initial state.
@@ -80,6 +95,96 @@ r_rendertext(r_font_t font, char const *text, u8 r, u8 g, u8 b, u8 a)
 	return tex;
 }
 
+// returns a texture of the text that stays owned by the cache, rendering it only
+// if it is not already cached. the texture is valid until the next call.
+SDL_Texture *
+r_cachedtext(r_font_t font, char const *text, u8 r, u8 g, u8 b, u8 a)
+{
+	u32 color = (u32)r << 24 | (u32)g << 16 | (u32)b << 8 | a;
+	u64 hash = r_hashtext(font, text, color);
+	
+	for (usize i = 0; i < r_ncachedtexts; ++i)
+	{
+		r_cachedtext_t *ct = &r_textcache[i];
+		if (ct->hash == hash && ct->font == font && ct->color == color && !strcmp(ct->text, text))
+		{
+			ct->lastuse = ++r_textcacheclock;
+			return ct->tex;
+		}
+	}
+	
+	SDL_Texture *tex = r_rendertext(font, text, r, g, b, a);
+	if (!tex)
+	{
+		return NULL;
+	}
+	
+	i32 w, h;
+	SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+	u32 size = 4 * w * h;
+	
+	while (r_ncachedtexts && (r_ncachedtexts >= O_MAXCACHEDTEXTS || r_textcachebytes + size > O_TEXTCACHEBYTES))
+	{
+		r_evicttext();
+	}
+	
+	r_textcache[r_ncachedtexts++] = (r_cachedtext_t)
+	{
+		.tex = tex,
+		.text = strdup(text),
+		.hash = hash,
+		.lastuse = ++r_textcacheclock,
+		.color = color,
+		.size = size,
+		.font = font
+	};
+	r_textcachebytes += size;
+	
+	return tex;
+}
+
+// draws text from the font's glyph atlas, stretching it over the destination
+// like r_rendertext() output would be. fails without drawing anything if the
+// text has characters outside the atlas.
+i32
+r_renderatlastext(r_font_t font, i32 x, i32 y, i32 w, i32 h, char const *text, u8 r, u8 g, u8 b, u8 a)
+{
+	r_atlas_t const *atlas = &r_atlases[font];
+	
+	usize len = 0;
+	for (; text[len]; ++len)
+	{
+		if (text[len] < R_ATLASFIRST || text[len] > R_ATLASLAST)
+		{
+			return 1;
+		}
+	}
+	
+	SDL_SetTextureColorMod(atlas->tex, r, g, b);
+	SDL_SetTextureAlphaMod(atlas->tex, a);
+	
+	for (usize i = 0; i < len; ++i)
+	{
+		i32 glyph = text[i] - R_ATLASFIRST;
+		SDL_Rect src =
+		{
+			.x = glyph % R_ATLASCOLS * atlas->cellw,
+			.y = glyph / R_ATLASCOLS * atlas->cellh,
+			.w = atlas->cellw,
+			.h = atlas->cellh
+		};
+		
+		// glyph edges are computed from the whole width to avoid accumulating
+		// rounding error across long lines.
+		i32 x0 = x + (i64)w * (i64)i / (i64)len, x1 = x + (i64)w * (i64)(i + 1) / (i64)len;
+		SDL_Rect dst = {x0, y, x1 - x0, h};
+		
+		SDL_RenderCopy(r_rend, atlas->tex, &src, &dst);
+	}
+	
+	return 0;
+}
+
 void
 r_tglrenderrect(i32 x, i32 y, i32 w, i32 h, z_color_t col)
 {
@@ -98,7 +203,25 @@ r_tglrenderrect(i32 x, i32 y, i32 w, i32 h, z_color_t col)
 void
 r_tglrendertext(i32 x, i32 y, i32 w, i32 h, char const *text, z_color_t col)
 {
-	SDL_Texture *tex = r_rendertext(
+	i32 rc = r_renderatlastext(
+		R_VCROSDMONO,
+		x,
+		y,
+		w,
+		h,
+		text,
+		z_defaultcolors[col][0],
+		z_defaultcolors[col][1],
+		z_defaultcolors[col][2],
+		z_defaultcolors[col][3]
+	);
+	if (!rc)
+	{
+		return;
+	}
+	
+	// fall back to rendering text with glyphs the atlas does not have.
+	SDL_Texture *tex = r_cachedtext(
 		R_VCROSDMONO,
 		text,
 		z_defaultcolors[col][0],
@@ -109,6 +232,109 @@ r_tglrendertext(i32 x, i32 y, i32 w, i32 h, char const *text, z_color_t col)
 	
 	SDL_Rect dst = {x, y, w, h};
 	SDL_RenderCopy(r_rend, tex, NULL, &dst);
+}
+
+static i32
+r_buildatlas(r_font_t font)
+{
+	// the atlas is laid out as a grid of equally sized cells, which assumes a
+	// monospace font.
+	i32 cellw, cellh;
+	if (TTF_SizeText(r_fonts[font], " ", &cellw, &cellh))
+	{
+		z_err("render: failed to size font glyphs - %s!", TTF_GetError());
+		return 1;
+	}
+	
+	i32 nglyphs = R_ATLASLAST - R_ATLASFIRST + 1;
+	i32 nrows = (nglyphs + R_ATLASCOLS - 1) / R_ATLASCOLS;
+	
+	SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(
+		0,
+		R_ATLASCOLS * cellw,
+		nrows * cellh,
+		32,
+		SDL_PIXELFORMAT_RGBA32
+	);
+	if (!surf)
+	{
+		z_err("render: failed to create atlas surface - %s!", SDL_GetError());
+		return 1;
+	}
+	
+	// glyphs are rendered white so that color modulation gives any color.
+	for (i32 i = 0; i < nglyphs; ++i)
+	{
+		SDL_Surface *glyph = TTF_RenderGlyph_Solid(
+			r_fonts[font],
+			R_ATLASFIRST + i,
+			(SDL_Color){255, 255, 255, 255}
+		);
+		if (!glyph)
+		{
+			// a glyph missing from the font is left blank.
+			continue;
+		}
+		
+		SDL_Rect src =
+		{
+			.w = glyph->w < cellw ? glyph->w : cellw,
+			.h = glyph->h < cellh ? glyph->h : cellh
+		};
+		SDL_Rect dst = {i % R_ATLASCOLS * cellw, i / R_ATLASCOLS * cellh, 0, 0};
+		SDL_BlitSurface(glyph, &src, surf, &dst);
+		
+		SDL_FreeSurface(glyph);
+	}
+	
+	SDL_Texture *tex = SDL_CreateTextureFromSurface(r_rend, surf);
+	SDL_FreeSurface(surf);
+	if (!tex)
+	{
+		z_err("render: failed to create atlas texture - %s!", SDL_GetError());
+		return 1;
+	}
+	SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+	
+	r_atlases[font] = (r_atlas_t)
+	{
+		.tex = tex,
+		.cellw = cellw,
+		.cellh = cellh
+	};
+	
+	return 0;
+}
+
+// FNV-1a over the text, mixed with the rest of the cache key.
+static u64
+r_hashtext(r_font_t font, char const *text, u32 color)
+{
+	u64 hash = 0xcbf29ce484222325;
+	for (usize i = 0; text[i]; ++i)
+	{
+		hash ^= (u8)text[i];
+		hash *= 0x100000001b3;
+	}
+	
+	hash ^= (u64)color << 8 | font;
+	hash *= 0x100000001b3;
+	
+	return hash;
+}
+
+static void
+r_evicttext(void)
+{
+	usize lru = 0;
+	for (usize i = 1; i < r_ncachedtexts; ++i)
+	{
+		lru = r_textcache[i].lastuse < r_textcache[lru].lastuse ? i : lru;
+	}
+	
+	SDL_DestroyTexture(r_textcache[lru].tex);
+	free(r_textcache[lru].text);
+	r_textcachebytes -= r_textcache[lru].size;
 	
-	SDL_DestroyTexture(tex);
+	r_textcache[lru] = r_textcache[--r_ncachedtexts];
 }
@@ -1,5 +1,10 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
+// glyphs of the printable ASCII range are prerendered into an atlas texture.
+#define R_ATLASFIRST ' '
+#define R_ATLASLAST '~'
+#define R_ATLASCOLS 16
+
 typedef enum r_font
 {
 	R_VCROSDMONO = 0,
@@ -7,11 +12,29 @@ typedef enum r_font
 	R_FONT_END
 } r_font_t;
 
+typedef struct r_atlas
+{
+	SDL_Texture *tex;
+	i32 cellw, cellh;
+} r_atlas_t;
+
+typedef struct r_cachedtext
+{
+	SDL_Texture *tex;
+	char *text;
+	u64 hash, lastuse;
+	u32 color, size;
+	r_font_t font;
+} r_cachedtext_t;
+
 extern SDL_Window *r_wnd;
 extern SDL_Renderer *r_rend;
 extern TTF_Font *r_fonts[R_FONT_END];
+extern r_atlas_t r_atlases[R_FONT_END];
 
 i32 r_init(void);
 SDL_Texture *r_rendertext(r_font_t font, char const *text, u8 r, u8 g, u8 b, u8 a);
+SDL_Texture *r_cachedtext(r_font_t font, char const *text, u8 r, u8 g, u8 b, u8 a);
+i32 r_renderatlastext(r_font_t font, i32 x, i32 y, i32 w, i32 h, char const *text, u8 r, u8 g, u8 b, u8 a);
 void r_tglrenderrect(i32 x, i32 y, i32 w, i32 h, z_color_t col);
 void r_tglrendertext(i32 x, i32 y, i32 w, i32 h, char const *text, z_color_t col);
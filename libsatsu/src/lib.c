@@ -2,13 +2,23 @@
 
 // standard library.
 #include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <math.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <string.h>
+#include <time.h>
 
 // system dependencies.
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 // project headers.
@@ -19,6 +29,7 @@
 #include "ls_exec.c"
 #include "ls_lex.c"
 #include "ls_parse.c"
+#include "ls_prof.c"
 #include "ls_sema.c"
 #include "ls_util.c"
 
@@ -10,69 +10,237 @@ typedef enum ls_execaction
 	LS_NEXTITER
 } ls_execaction_t;
 
+// fused operations, which ls_fuseops() substitutes for common idioms in the
+// dispatch table of an execution. they are numbered after the node types so
+// that both can index ls_execfns.
+typedef enum ls_execop
+{
+	LS_XFORCOUNT = LS_NODETYPE_END, // for (new int i = a; i < b; i += c).
+	LS_XCMPIMM, // x < 3.
+	LS_XMODZERO, // x % 3 == 0.
+	
+	LS_EXECOP_END
+} ls_execop_t;
+
+typedef enum ls_operandkind
+{
+	LS_OPIMM = 0,
+	LS_OPLOCAL,
+	LS_OPGLOBAL
+} ls_operandkind_t;
+
+typedef struct ls_execframe
+{
+	uint32_t node;
+	uint32_t stage;
+	uint32_t aux;
+} ls_execframe_t;
+
+typedef struct ls_fdreader
+{
+	char *buf;
+	uint32_t pos, len;
+	int32_t fd;
+	bool eof;
+} ls_fdreader_t;
+
+typedef struct ls_fdwriter
+{
+	char *buf;
+	uint32_t len;
+	int32_t fd;
+	bool linebuf;
+} ls_fdwriter_t;
+
+// a bound or step of a counted loop, either an immediate or a symbol which is
+// read on every iteration.
+typedef struct ls_loopoperand
+{
+	int64_t imm;
+	uint32_t sym;
+	uint8_t kind; // ls_operandkind_t.
+} ls_loopoperand_t;
+
+typedef struct ls_countedloop
+{
+	ls_loopoperand_t bound, step;
+	uint32_t var;
+	uint8_t cmp; // ls_nodetype_t.
+	bool down; // the step is subtracted.
+} ls_countedloop_t;
+
 typedef struct ls_exec
 {
 	ls_module_t const *m;
 	ls_sysfns_t const *sf;
-	ls_symtab_t *globalst;
+	ls_symtab_t globalst;
 	FILE *logfp;
 	
+	// function environments.
 	void *buf;
 	ls_symtab_t *localsts;
 	uint16_t *scopes;
 	uint32_t *mods;
+	uint32_t *fnframes; // index of the function declaration frame.
 	uint32_t fndepth, fndepthcap;
+	
+	// node frames and intermediate values.
+	ls_execframe_t *frames;
+	ls_val_t *vals;
+	uint32_t nframes, framecap;
+	uint32_t nvals, valcap;
+	uint8_t action; // ls_execaction_t.
+	
+	// dispatch tables of each module, and the values of their integer literals,
+	// indexed by node.
+	void *opbuf;
+	uint8_t **ops; // ls_nodetype_t or ls_execop_t.
+	int64_t **ints;
+	
+	// counted loops being run by fused for nodes, innermost last.
+	ls_countedloop_t *loops;
+	uint32_t nloops, loopcap;
+	
+	// set while the top frame waits on an asynchronous system function.
+	bool pending;
+	void *user;
+	
+	// the cancellation token, and whether the execution was cancelled by it.
+	ls_cancel_t const *cancel;
+	bool cancelled;
+	
+	// buffers of the long strings created by the execution, if
+	// ls_conf.execarena was set at creation.
+	ls_arena_t *arena;
+	
+	// set while the execution is being profiled or traced.
+	ls_profile_t *prof;
+	ls_trace_t *trace;
+	
+	// console buffers.
+	char cout[LS_CBUFSIZE], cin[LS_CBUFSIZE];
+	uint32_t ncout;
+	uint32_t cinpos, ncin;
+	
+	// buffered file descriptor readers, created on first use.
+	ls_fdreader_t *rds;
+	uint32_t nrds, rdcap;
+	
+	// buffered file descriptor writers, created on first use.
+	ls_fdwriter_t *wrs;
+	uint32_t nwrs, wrcap;
+	
+	// results of the last shell command.
+	ls_val_t shellout;
+	int64_t shellrc;
+	
+	// scratch space for building strings of unknown length.
+	char *tmp;
+	size_t tmpcap;
 } ls_exec_t;
 
-static ls_exec_t ls_createexec(ls_module_t const *m, ls_sysfns_t const *sf, ls_symtab_t *globalst, FILE *logfp);
-static void ls_destroyexec(ls_exec_t *e);
+static void ls_profsignal(int sig);
+static void ls_sampleprofile(ls_exec_t *e);
+static void ls_tracestep(ls_exec_t *e, ls_execframe_t *f);
 static void ls_pushexecfn(ls_exec_t *e, uint32_t mod, ls_symtab_t *st);
 static void ls_popexecfn(ls_exec_t *e);
+static bool ls_checkcancel(ls_exec_t *e);
+static void ls_unwindexec(ls_exec_t *e);
+static void ls_fuseops(ls_exec_t *e);
+static size_t ls_opbytes(ls_module_t const *m);
+static bool ls_isintlit(ls_module_t const *m, uint32_t mod, uint32_t node);
+static bool ls_isident(ls_module_t const *m, uint32_t mod, uint32_t node, uint32_t tok);
+static bool ls_isloopoperand(ls_module_t const *m, uint32_t mod, uint32_t node);
+static bool ls_iscountedloop(ls_module_t const *m, uint32_t mod, uint32_t node);
+static bool ls_ismodzero(ls_module_t const *m, uint32_t mod, int64_t const *ints, uint32_t node);
+static bool ls_cmpint(ls_nodetype_t cmp, int64_t l, int64_t r);
+static size_t ls_framebytes(ls_exec_t const *e);
+static void ls_pushexecnode(ls_exec_t *e, uint32_t node);
+static void ls_retexecnode(ls_exec_t *e, ls_val_t v);
+static bool ls_execnext(ls_exec_t *e, ls_execframe_t *f, uint32_t first, uint32_t last);
+static void ls_pushval(ls_exec_t *e, ls_val_t v);
+static ls_val_t ls_popval(ls_exec_t *e);
+static ls_val_t ls_atomval(ls_exec_t *e, uint32_t node);
+static void ls_execcwrite(ls_exec_t *e, char const *buf, size_t len);
+static void ls_execcflush(ls_exec_t *e);
+static ls_fdreader_t *ls_execreader(ls_exec_t *e, int32_t fd);
+static bool ls_fillreader(ls_exec_t *e, ls_fdreader_t *rd);
+static ls_fdwriter_t *ls_execwriter(ls_exec_t *e, int32_t fd);
+static void ls_writewriter(ls_exec_t *e, ls_fdwriter_t *wr, char const *data, size_t len);
+static void ls_flushwriter(ls_exec_t *e, ls_fdwriter_t *wr);
+static void ls_flushwriters(ls_exec_t *e);
+static void ls_writeiov(ls_exec_t *e, int32_t fd, struct iovec *iov, int niov);
+static void ls_dropfd(ls_exec_t *e, int32_t fd);
+static char *ls_reservetmp(ls_exec_t *e, size_t cap);
+static int ls_cmpstr(ls_val_t const *a, ls_val_t const *b);
+static char *ls_allocexecstr(ls_exec_t *e, ls_val_t *out, size_t len);
+static ls_val_t ls_newexecstr(ls_exec_t *e, char const *s, size_t len);
+static ls_val_t ls_catstr(ls_exec_t *e, ls_val_t const *a, ls_val_t const *b);
+static void ls_settlestr(ls_val_t *v);
+static void ls_substr(ls_val_t *v, size_t off, size_t len);
 static ls_val_t ls_sysprint(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
 static ls_val_t ls_syscprint(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
 static ls_val_t ls_sysreadln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_syshasln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_sysflush(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
 static ls_val_t ls_syscreadln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
 static ls_val_t ls_sysshell(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
-static ls_execaction_t ls_execfuncdecl(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execlocaldecl(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execreturn(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execctree(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execwhile(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execfor(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execbreak(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execcontinue(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execblock(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeatom(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execesystem(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_exececall(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeaccess(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeneg(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execenot(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execemul(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execediv(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execemod(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeadd(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execesub(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeless(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execelequal(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execegreater(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execegrequal(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeequal(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execenequal(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeand(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeor(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execexor(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeternary(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeassign(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execeaddassign(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execesubassign(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execemulassign(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execedivassign(ls_val_t *out, ls_exec_t *e, uint32_t node);
-static ls_execaction_t ls_execemodassign(ls_val_t *out, ls_exec_t *e, uint32_t node);
+static ls_val_t ls_sysshellrc(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_sysshellout(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_sysfopen(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_sysfread(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_sysfclose(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static ls_val_t ls_sysfmap(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS]);
+static void ls_execfuncdecl(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execlocaldecl(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execreturn(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execctree(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execwhile(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execfor(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execbreak(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execcontinue(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execblock(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeatom(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execesystem(ls_exec_t *e, ls_execframe_t *f);
+static void ls_exececall(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeaccess(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeneg(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execenot(ls_exec_t *e, ls_execframe_t *f);
+static void ls_exececast(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execemul(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execediv(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execemod(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeadd(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execesub(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeless(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execelequal(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execegreater(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execegrequal(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeequal(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execenequal(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeand(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeor(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execexor(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeternary(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeassign(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execeaddassign(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execesubassign(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execemulassign(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execedivassign(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execemodassign(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execxforcount(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execxcmpimm(ls_exec_t *e, ls_execframe_t *f);
+static void ls_execxmodzero(ls_exec_t *e, ls_execframe_t *f);
 static ls_val_t *ls_assignmentdst(ls_exec_t *e, uint32_t mod, uint32_t node);
+static void ls_pushloop(ls_exec_t *e, ls_countedloop_t c);
+static ls_loopoperand_t ls_resolveoperand(ls_exec_t *e, uint32_t node);
+static int64_t ls_readoperand(ls_exec_t const *e, ls_loopoperand_t const *o);
+
+// timer ticks not yet sampled by the profiled execution.
+static volatile sig_atomic_t ls_profticks;
+static struct sigaction ls_oldprofaction;
 
-static ls_execaction_t (*ls_execfns[LS_NODETYPE_END])(ls_val_t *, ls_exec_t *, uint32_t) =
+static void (*ls_execfns[LS_EXECOP_END])(ls_exec_t *, ls_execframe_t *) =
 {
 	// structure nodes.
 	[LS_NULL] = NULL,
@@ -123,6 +291,11 @@ static ls_execaction_t (*ls_execfns[LS_NODETYPE_END])(ls_val_t *, ls_exec_t *, u
 	[LS_EMULASSIGN] = ls_execemulassign,
 	[LS_EDIVASSIGN] = ls_execedivassign,
 	[LS_EMODASSIGN] = ls_execemodassign,
+	
+	// fused operations.
+	[LS_XFORCOUNT] = ls_execxforcount,
+	[LS_XCMPIMM] = ls_execxcmpimm,
+	[LS_XMODZERO] = ls_execxmodzero
 };
 
 ls_val_t
@@ -143,7 +316,8 @@ ls_defaultval(ls_primtype_t type)
 	}
 	else if (type == LS_STRING)
 	{
-		v.data.string = ls_strdup("");
+		v.data.smallstring.len = 0;
+		v.small = true;
 	}
 	else if (type == LS_BOOL)
 	{
@@ -153,30 +327,216 @@ ls_defaultval(ls_primtype_t type)
 	return v;
 }
 
+// strings are immutable, so copies share their buffer.
 ls_val_t
 ls_copyval(ls_val_t const *v)
 {
-	if (v->type == LS_STRING)
+	if (v->type == LS_STRING && !v->small)
 	{
-		return (ls_val_t)
+		++v->data.string.buf->refs;
+	}
+	return *v;
+}
+
+// the buffer of a string is released along with its last reference.
+void
+ls_destroyval(ls_val_t *v)
+{
+	if (v->type != LS_STRING || v->small)
+	{
+		return;
+	}
+	
+	ls_strbuf_t *buf = v->data.string.buf;
+	if (--buf->refs)
+	{
+		return;
+	}
+	
+	if (buf->kind == LS_ARENASTR)
+	{
+		return;
+	}
+	
+	if (buf->kind == LS_MAPSTR)
+	{
+		ls_countmem(LS_MEMSTRINGS, sizeof(ls_strbuf_t) + buf->len, 0);
+		munmap(buf->data, buf->len);
+	}
+	else
+	{
+		ls_countmem(LS_MEMSTRINGS, sizeof(ls_strbuf_t) + buf->len + 1, 0);
+	}
+	ls_free(buf);
+}
+
+// returns the writable data of a new string of the given length, which must be
+// filled in before the string is used. short strings need no allocation.
+char *
+ls_allocstr(ls_val_t *out, size_t len)
+{
+	if (len <= LS_MAXSMALLSTR)
+	{
+		*out = (ls_val_t)
 		{
 			.type = LS_STRING,
-			.data.string = ls_strdup(v->data.string)
+			.data.smallstring.len = len,
+			.small = true
 		};
+		return out->data.smallstring.data;
 	}
-	else
+	
+	ls_strbuf_t *buf = ls_malloc(sizeof(ls_strbuf_t) + len + 1);
+	ls_countmem(LS_MEMSTRINGS, 0, sizeof(ls_strbuf_t) + len + 1);
+	*buf = (ls_strbuf_t)
+	{
+		.data = (char *)(buf + 1),
+		.len = len,
+		.refs = 1,
+		.kind = LS_HEAPSTR
+	};
+	buf->data[len] = 0;
+	
+	*out = (ls_val_t)
+	{
+		.type = LS_STRING,
+		.data.string =
+		{
+			.buf = buf,
+			.len = len
+		}
+	};
+	return buf->data;
+}
+
+ls_val_t
+ls_newstr(char const *s, size_t len)
+{
+	ls_val_t v;
+	ls_memcpy(ls_allocstr(&v, len), s, len);
+	return v;
+}
+
+// string data is not necessarily null terminated, nor free of null bytes.
+char const *
+ls_strptr(ls_val_t const *v)
+{
+	if (v->small)
 	{
-		return *v;
+		return v->data.smallstring.data;
 	}
+	return &v->data.string.buf->data[v->data.string.off];
 }
 
-void
-ls_destroyval(ls_val_t *v)
+size_t
+ls_strlen(ls_val_t const *v)
+{
+	return v->small ? v->data.smallstring.len : v->data.string.len;
+}
+
+// returns a null terminated copy of the string, to be freed by the caller.
+char *
+ls_cstr(ls_val_t const *v)
+{
+	size_t len = ls_strlen(v);
+	
+	char *s = ls_malloc(len + 1);
+	ls_memcpy(s, ls_strptr(v), len);
+	s[len] = 0;
+	
+	return s;
+}
+
+// a view which is the last reference to a much larger buffer is copied out, so
+// that the rest of the buffer can be released. this is done as values are
+// stored, as that is when a slice may outlive the string it was taken from.
+// arena buffers are never released early, so their views are left alone.
+static void
+ls_settlestr(ls_val_t *v)
+{
+	if (v->type != LS_STRING || v->small)
+	{
+		return;
+	}
+	
+	ls_strbuf_t *buf = v->data.string.buf;
+	if (buf->kind == LS_ARENASTR || buf->refs > 1 || v->data.string.len >= buf->len / 2)
+	{
+		return;
+	}
+	
+	ls_val_t out = ls_newstr(ls_strptr(v), ls_strlen(v));
+	ls_destroyval(v);
+	*v = out;
+}
+
+// like ls_allocstr(), but long strings are allocated from the execution's arena
+// while it has room.
+static char *
+ls_allocexecstr(ls_exec_t *e, ls_val_t *out, size_t len)
+{
+	if (!e->arena || len <= LS_MAXSMALLSTR)
+	{
+		return ls_allocstr(out, len);
+	}
+	
+	ls_strbuf_t *buf = ls_arenaalloc(e->arena, sizeof(ls_strbuf_t) + len + 1);
+	if (!buf)
+	{
+		return ls_allocstr(out, len);
+	}
+	
+	*buf = (ls_strbuf_t)
+	{
+		.data = (char *)(buf + 1),
+		.len = len,
+		.refs = 1,
+		.kind = LS_ARENASTR
+	};
+	buf->data[len] = 0;
+	
+	*out = (ls_val_t)
+	{
+		.type = LS_STRING,
+		.data.string =
+		{
+			.buf = buf,
+			.len = len
+		}
+	};
+	return buf->data;
+}
+
+static ls_val_t
+ls_newexecstr(ls_exec_t *e, char const *s, size_t len)
+{
+	ls_val_t v;
+	ls_memcpy(ls_allocexecstr(e, &v, len), s, len);
+	return v;
+}
+
+// narrows the string to the given part of itself. a long result stays a view
+// into the same buffer, while a short one is copied into the value.
+static void
+ls_substr(ls_val_t *v, size_t off, size_t len)
 {
-	if (v->type == LS_STRING)
+	if (v->small)
 	{
-		ls_free(v->data.string);
+		ls_memmove(v->data.smallstring.data, &v->data.smallstring.data[off], len);
+		v->data.smallstring.len = len;
+		return;
 	}
+	
+	if (len <= LS_MAXSMALLSTR)
+	{
+		ls_val_t out = ls_newstr(&ls_strptr(v)[off], len);
+		ls_destroyval(v);
+		*v = out;
+		return;
+	}
+	
+	v->data.string.off += off;
+	v->data.string.len = len;
 }
 
 ls_sysfns_t
@@ -191,6 +551,7 @@ ls_emptysysfns(void)
 	{
 		{(void **)&sf.names, 1, sizeof(char *)},
 		{(void **)&sf.callbacks, 1, sizeof(ls_val_t (*)(ls_val_t[LS_MAXSYSARGS]))},
+		{(void **)&sf.asynccallbacks, 1, sizeof(ls_sysstatus_t (*)(ls_val_t[LS_MAXSYSARGS], ls_val_t *))},
 		{(void **)&sf.rettypes, 1, sizeof(uint8_t)},
 		{(void **)&sf.argtypes, 1, sizeof(uint8_t[LS_MAXSYSARGS])},
 		{(void **)&sf.nargs, 1, sizeof(uint8_t)}
@@ -220,13 +581,45 @@ ls_basesysfns(void)
 	types[0] = LS_INT;
 	ls_pushsysfn(&sf, "readln", ls_sysreadln, LS_STRING, types, 1);
 	
+	// system bool hasln(int).
+	types[0] = LS_INT;
+	ls_pushsysfn(&sf, "hasln", ls_syshasln, LS_BOOL, types, 1);
+	
+	// system void flush(int).
+	types[0] = LS_INT;
+	ls_pushsysfn(&sf, "flush", ls_sysflush, LS_VOID, types, 1);
+	
 	// system string creadln().
 	ls_pushsysfn(&sf, "creadln", ls_syscreadln, LS_STRING, types, 0);
 	
-	// system int shell(string).
+	// system bool shell(string).
 	types[0] = LS_STRING;
 	ls_pushsysfn(&sf, "shell", ls_sysshell, LS_BOOL, types, 1);
 	
+	// system int shellrc().
+	ls_pushsysfn(&sf, "shellrc", ls_sysshellrc, LS_INT, types, 0);
+	
+	// system string shellout().
+	ls_pushsysfn(&sf, "shellout", ls_sysshellout, LS_STRING, types, 0);
+	
+	// system int fopen(string, string).
+	types[0] = LS_STRING;
+	types[1] = LS_STRING;
+	ls_pushsysfn(&sf, "fopen", ls_sysfopen, LS_INT, types, 2);
+	
+	// system string fread(int, int).
+	types[0] = LS_INT;
+	types[1] = LS_INT;
+	ls_pushsysfn(&sf, "fread", ls_sysfread, LS_STRING, types, 2);
+	
+	// system bool fclose(int).
+	types[0] = LS_INT;
+	ls_pushsysfn(&sf, "fclose", ls_sysfclose, LS_BOOL, types, 1);
+	
+	// system string fmap(string).
+	types[0] = LS_STRING;
+	ls_pushsysfn(&sf, "fmap", ls_sysfmap, LS_STRING, types, 1);
+	
 	return sf;
 }
 
@@ -265,6 +658,7 @@ ls_pushsysfn(
 		{
 			{(void **)&sf->names, sf->fncap, 2 * sf->fncap, sizeof(char *)},
 			{(void **)&sf->callbacks, sf->fncap, 2 * sf->fncap, sizeof(ls_val_t (*)(ls_val_t[LS_MAXSYSARGS]))},
+			{(void **)&sf->asynccallbacks, sf->fncap, 2 * sf->fncap, sizeof(ls_sysstatus_t (*)(ls_val_t[LS_MAXSYSARGS], ls_val_t *))},
 			{(void **)&sf->rettypes, sf->fncap, 2 * sf->fncap, sizeof(uint8_t)},
 			{(void **)&sf->argtypes, sf->fncap, 2 * sf->fncap, sizeof(uint8_t[LS_MAXSYSARGS])},
 			{(void **)&sf->nargs, sf->fncap, 2 * sf->fncap, sizeof(uint8_t)}
@@ -276,6 +670,7 @@ ls_pushsysfn(
 	
 	sf->names[sf->nfns] = name;
 	sf->callbacks[sf->nfns] = callback;
+	sf->asynccallbacks[sf->nfns] = NULL;
 	sf->rettypes[sf->nfns] = rettype;
 	for (size_t i = 0; i < LS_MAXSYSARGS; ++i)
 	{
@@ -285,10 +680,59 @@ ls_pushsysfn(
 	++sf->nfns;
 }
 
+// an asynchronous system function may finish its work immediately (writing
+// *out and returning LS_SYSDONE) or return LS_SYSPENDING, in which case the
+// execution parks until the host calls ls_completesysfn(). arguments are
+// destroyed once the callback returns, so anything needed to complete the
+// request later must be copied.
+void
+ls_pushasyncsysfn(
+	ls_sysfns_t *sf,
+	char const *name,
+	ls_sysstatus_t (*callback)(ls_exec_t *, ls_val_t[LS_MAXSYSARGS], ls_val_t *),
+	ls_primtype_t rettype,
+	ls_primtype_t argtypes[LS_MAXSYSARGS],
+	uint8_t nargs
+)
+{
+	ls_pushsysfn(sf, name, NULL, rettype, argtypes, nargs);
+	sf->asynccallbacks[sf->nfns - 1] = callback;
+}
+
+ls_err_t
+ls_exec(
+	ls_module_t const *m,
+	FILE *logfp,
+	ls_sysfns_t const *sf,
+	char const *entry
+)
+{
+	ls_exec_t *e;
+	ls_err_t err = ls_createexec(&e, m, logfp, sf, entry);
+	if (err.code)
+	{
+		return err;
+	}
+	
+	if (ls_resumeexec(e, 0) == LS_EXECPENDING)
+	{
+		ls_destroyexec(e);
+		return (ls_err_t)
+		{
+			.code = 1,
+			.msg = ls_strdup("script waited on an asynchronous system function")
+		};
+	}
+	
+	ls_destroyexec(e);
+	return (ls_err_t){0};
+}
+
 // very little error checking is performed during execution as it is assumed
 // that semantic analysis has already caught most potential errors.
 ls_err_t
-ls_exec(
+ls_createexec(
+	ls_exec_t **out,
 	ls_module_t const *m,
 	FILE *logfp,
 	ls_sysfns_t const *sf,
@@ -309,6 +753,7 @@ ls_exec(
 	int64_t entryfn = ls_findsym(&globalst, entry);
 	if (entryfn == -1)
 	{
+		ls_destroysymtab(&globalst);
 		return (ls_err_t)
 		{
 			.code = 1,
@@ -318,6 +763,7 @@ ls_exec(
 	
 	if (globalst.types[entryfn] != LS_FUNC)
 	{
+		ls_destroysymtab(&globalst);
 		return (ls_err_t)
 		{
 			.code = 1,
@@ -336,6 +782,7 @@ ls_exec(
 	ls_primtype_t rettype = ls_toktoprim[typetok];
 	if (rettype != LS_VOID)
 	{
+		ls_destroysymtab(&globalst);
 		return (ls_err_t)
 		{
 			.code = 1,
@@ -345,6 +792,7 @@ ls_exec(
 	
 	if (a->nodes[narglist].nchildren != 0)
 	{
+		ls_destroysymtab(&globalst);
 		return (ls_err_t)
 		{
 			.code = 1,
@@ -352,748 +800,1975 @@ ls_exec(
 		};
 	}
 	
-	ls_exec_t e = ls_createexec(m, sf, &globalst, logfp);
-	ls_symtab_t newlocalst = ls_createsymtab();
-	
-	ls_pushexecfn(&e, globalst.mods[entryfn], &newlocalst);
-	
-	ls_val_t v = {0};
-	ls_execfuncdecl(&v, &e, globalst.nodes[entryfn]);
-	ls_destroyval(&v);
-	
-	ls_destroyexec(&e);
-	ls_destroysymtab(&globalst);
-	return (ls_err_t){0};
-}
-
-static ls_exec_t
-ls_createexec(
-	ls_module_t const *m,
-	ls_sysfns_t const *sf,
-	ls_symtab_t *globalst,
-	FILE *logfp
-)
-{
-	ls_exec_t e =
+	ls_exec_t *e = ls_malloc(sizeof(ls_exec_t));
+	*e = (ls_exec_t)
 	{
 		.m = m,
 		.sf = sf,
 		.globalst = globalst,
 		.logfp = logfp,
-		.fndepthcap = 1
+		.fndepthcap = 1,
+		.framecap = 1,
+		.valcap = 1,
+		.loopcap = 1,
+		.rdcap = 1,
+		.wrcap = 1
 	};
 	
 	ls_allocbatch_t allocs[] =
 	{
-		{(void **)&e.localsts, 1, sizeof(ls_symtab_t)},
-		{(void **)&e.scopes, 1, sizeof(uint16_t)},
-		{(void **)&e.mods, 1, sizeof(uint32_t)}
+		{(void **)&e->localsts, 1, sizeof(ls_symtab_t)},
+		{(void **)&e->scopes, 1, sizeof(uint16_t)},
+		{(void **)&e->mods, 1, sizeof(uint32_t)},
+		{(void **)&e->fnframes, 1, sizeof(uint32_t)}
 	};
-	e.buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	e->buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	e->frames = ls_calloc(1, sizeof(ls_execframe_t));
+	e->vals = ls_calloc(1, sizeof(ls_val_t));
+	e->loops = ls_calloc(1, sizeof(ls_countedloop_t));
+	ls_countmem(LS_MEMFRAMES, 0, ls_framebytes(e));
+	e->rds = ls_calloc(1, sizeof(ls_fdreader_t));
+	e->wrs = ls_calloc(1, sizeof(ls_fdwriter_t));
+	e->shellout = ls_defaultval(LS_STRING);
+	e->tmp = ls_malloc(LS_FDBUFSIZE);
+	e->tmpcap = LS_FDBUFSIZE;
+	e->arena = ls_conf.execarena ? ls_calloc(1, sizeof(ls_arena_t)) : NULL;
+	ls_fuseops(e);
+	
+	ls_symtab_t newlocalst = ls_createsymtab();
+	ls_pushexecfn(e, e->globalst.mods[entryfn], &newlocalst);
+	ls_pushexecnode(e, nfuncdecl);
 	
-	return e;
+	*out = e;
+	return (ls_err_t){0};
 }
 
-static void
+// runs the execution for at most nsteps node steps, or until it finishes if
+// nsteps is zero. a yielded execution keeps all of its state in *e, so the host
+// can continue it later (and from any thread) with another call. a pending
+// execution makes no progress until its system function is completed.
+ls_execstatus_t
+ls_resumeexec(ls_exec_t *e, uint32_t nsteps)
+{
+	ls_execstatus_t status = LS_EXECDONE;
+	for (uint32_t step = 0; e->nframes; ++step)
+	{
+		if (e->pending)
+		{
+			status = LS_EXECPENDING;
+			break;
+		}
+		
+		if (nsteps && step >= nsteps)
+		{
+			status = LS_EXECYIELD;
+			break;
+		}
+		
+		if (e->prof && ls_profticks)
+		{
+			ls_sampleprofile(e);
+		}
+		
+		ls_execframe_t *f = &e->frames[e->nframes - 1];
+		if (e->trace)
+		{
+			ls_tracestep(e, f);
+			continue;
+		}
+		
+		ls_execfns[e->ops[e->mods[e->fndepth - 1]][f->node]](e, f);
+	}
+	
+	if (e->cancelled)
+	{
+		status = LS_EXECCANCELLED;
+	}
+	
+	// output is never held back while the host has control.
+	ls_execcflush(e);
+	ls_flushwriters(e);
+	
+	return status;
+}
+
+// an execution may be destroyed at any point, finished or not.
+void
 ls_destroyexec(ls_exec_t *e)
 {
+	ls_execcflush(e);
+	ls_flushwriters(e);
+	
+	for (size_t i = 0; i < e->nvals; ++i)
+	{
+		ls_destroyval(&e->vals[i]);
+	}
+	
 	for (size_t i = 0; i < e->fndepth; ++i)
 	{
 		ls_destroysymtab(&e->localsts[i]);
 	}
-	free(e->buf);
+	
+	for (size_t i = 0; i < e->nrds; ++i)
+	{
+		ls_free(e->rds[i].buf);
+	}
+	
+	for (size_t i = 0; i < e->nwrs; ++i)
+	{
+		ls_free(e->wrs[i].buf);
+	}
+	
+	ls_destroysymtab(&e->globalst);
+	ls_destroyval(&e->shellout);
+	ls_free(e->tmp);
+	ls_free(e->wrs);
+	ls_free(e->rds);
+	ls_countmem(LS_MEMFRAMES, ls_framebytes(e), 0);
+	ls_free(e->loops);
+	ls_free(e->vals);
+	ls_free(e->frames);
+	ls_free(e->buf);
+	ls_countmem(LS_MEMAST, ls_opbytes(e->m), 0);
+	ls_free(e->opbuf);
+	
+	// arena strings are released in bulk, all of the above releases of them
+	// having been no-ops.
+	if (e->arena)
+	{
+		ls_destroyarena(e->arena);
+		ls_free(e->arena);
+	}
+	
+	ls_free(e);
 }
 
-// *e takes ownership of *st.
-static void
-ls_pushexecfn(ls_exec_t *e, uint32_t mod, ls_symtab_t *st)
+// finishes the asynchronous system function the execution is waiting on, with
+// v as its return value. *e takes ownership of v. this must not be called
+// concurrently with ls_resumeexec() on the same execution.
+void
+ls_completesysfn(ls_exec_t *e, ls_val_t v)
 {
-	if (e->fndepth >= e->fndepthcap)
+	if (!e->pending)
 	{
-		ls_reallocbatch_t reallocs[] =
-		{
-			{(void **)&e->localsts, e->fndepthcap, 2 * e->fndepthcap, sizeof(ls_symtab_t)},
-			{(void **)&e->scopes, e->fndepthcap, 2 * e->fndepthcap, sizeof(uint16_t)},
-			{(void **)&e->mods, e->fndepthcap, 2 * e->fndepthcap, sizeof(uint32_t)}
-		};
-		
-		e->fndepthcap *= 2;
-		e->buf = ls_reallocbatch(e->buf, reallocs, ARRSIZE(reallocs));
+		fprintf(e->logfp, LS_ERR "completed system function when none was pending!\n");
+		ls_destroyval(&v);
+		return;
 	}
 	
-	e->localsts[e->fndepth] = *st;
-	e->scopes[e->fndepth] = 0;
-	e->mods[e->fndepth] = mod;
-	++e->fndepth;
+	e->pending = false;
+	
+	ls_execframe_t *f = &e->frames[e->nframes - 1];
+	ls_primtype_t rettype = e->sf->rettypes[f->aux];
+	if (rettype != LS_VOID && v.type != rettype)
+	{
+		fprintf(e->logfp, LS_ERR "system function %s completed with %s instead of %s!\n", e->sf->names[f->aux], ls_primtypenames[v.type], ls_primtypenames[rettype]);
+		ls_destroyval(&v);
+		v = ls_defaultval(rettype);
+	}
+	
+	ls_retexecnode(e, v);
 }
 
-static void
-ls_popexecfn(ls_exec_t *e)
+void
+ls_setexecuser(ls_exec_t *e, void *user)
 {
-	ls_destroysymtab(&e->localsts[--e->fndepth]);
+	e->user = user;
 }
 
-static ls_val_t
-ls_sysprint(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+void *
+ls_execuser(ls_exec_t const *e)
 {
-	char const *s = args[1].data.string;
-	if ((size_t)dprintf(args[0].data.int_, "%s", s) != strlen(s))
-	{
-		fprintf(e->logfp, LS_ERR "failure on dprintf() in system print!\n");
-	}
-	return ls_defaultval(LS_VOID);
+	return e->user;
 }
 
-static ls_val_t
-ls_syscprint(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+// samples the call stack of the execution hz times per second of process CPU
+// time, using SIGPROF. only one execution can be profiled at a time. samples
+// are taken between node steps, the signal handler only counting ticks.
+void
+ls_startprofile(ls_exec_t *e, ls_profile_t *p, uint32_t hz)
 {
-	(void)e;
+	e->prof = p;
+	ls_profticks = 0;
 	
-	char const *s = args[0].data.string;
-	while (*s)
+	struct sigaction action =
 	{
-		ls_conf.cput(*s);
-		++s;
-	}
-	return ls_defaultval(LS_VOID);
-}
+		.sa_handler = ls_profsignal,
+		.sa_flags = SA_RESTART
+	};
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, &ls_oldprofaction);
+	
+	uint32_t usec = hz ? 1000000 / hz : 1000;
+	struct itimerval timer =
+	{
+		.it_interval = {.tv_sec = usec / 1000000, .tv_usec = usec % 1000000},
+		.it_value = {.tv_sec = usec / 1000000, .tv_usec = usec % 1000000}
+	};
+	setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+void
+ls_stopprofile(ls_exec_t *e)
+{
+	struct itimerval timer = {0};
+	setitimer(ITIMER_PROF, &timer, NULL);
+	sigaction(SIGPROF, &ls_oldprofaction, NULL);
+	
+	e->prof = NULL;
+}
+
+// records into *t while it is set, NULL stopping the trace. tracing slows
+// execution down considerably, as every node step is timed. atoms evaluated in
+// place by their parent, and nodes folded into a fused operation, like the
+// condition of a counted loop, are not counted; their time goes to the parent.
+void
+ls_setexectrace(ls_exec_t *e, ls_trace_t *t)
+{
+	e->trace = t;
+}
+
+// stops the execution once the token is raised, with it returning
+// LS_EXECCANCELLED. the token is only checked at loop back-edges, function call
+// entry and while waiting on console input, so a script can still run for a
+// while between being cancelled and stopping if it blocks elsewhere.
+void
+ls_setexeccancel(ls_exec_t *e, ls_cancel_t const *c)
+{
+	e->cancel = c;
+}
+
+static void
+ls_profsignal(int sig)
+{
+	(void)sig;
+	++ls_profticks;
+}
+
+// each sample is weighted by the number of ticks since the last one.
+static void
+ls_sampleprofile(ls_exec_t *e)
+{
+	uint64_t weight = ls_profticks;
+	ls_profticks = 0;
+	
+	uint32_t *frames = (uint32_t *)ls_reservetmp(e, 2 * e->fndepth * sizeof(uint32_t));
+	for (uint32_t i = 0; i < e->fndepth; ++i)
+	{
+		frames[2 * i] = e->mods[i];
+		frames[2 * i + 1] = e->frames[e->fnframes[i]].node;
+	}
+	
+	uint32_t mod = e->mods[e->fndepth - 1];
+	ls_ast_t const *a = &e->m->asts[mod];
+	ls_lex_t const *l = &e->m->lexes[mod];
+	
+	uint32_t node = e->frames[e->nframes - 1].node;
+	uint32_t pos = l->toks[a->nodes[node].tok].pos;
+	
+	ls_addprofsample(e->prof, frames, e->fndepth, mod, pos, weight);
+}
+
+// runs one step of the frame's node, counting the node when it is entered and
+// timing the step.
+static void
+ls_tracestep(ls_exec_t *e, ls_execframe_t *f)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	uint32_t node = f->node;
+	
+	if (!f->stage)
+	{
+		++e->trace->counts[mod][node];
+	}
+	
+	struct timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	ls_execfns[e->ops[mod][node]](e, f);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	
+	e->trace->times[mod][node] += (end.tv_sec - begin.tv_sec) * 1000000000 + end.tv_nsec - begin.tv_nsec;
+}
+
+// *e takes ownership of *st.
+static void
+ls_pushexecfn(ls_exec_t *e, uint32_t mod, ls_symtab_t *st)
+{
+	if (e->fndepth >= e->fndepthcap)
+	{
+		ls_reallocbatch_t reallocs[] =
+		{
+			{(void **)&e->localsts, e->fndepthcap, 2 * e->fndepthcap, sizeof(ls_symtab_t)},
+			{(void **)&e->scopes, e->fndepthcap, 2 * e->fndepthcap, sizeof(uint16_t)},
+			{(void **)&e->mods, e->fndepthcap, 2 * e->fndepthcap, sizeof(uint32_t)},
+			{(void **)&e->fnframes, e->fndepthcap, 2 * e->fndepthcap, sizeof(uint32_t)}
+		};
+		
+		size_t oldsize = ls_framebytes(e);
+		e->fndepthcap *= 2;
+		e->buf = ls_reallocbatch(e->buf, reallocs, ARRSIZE(reallocs));
+		ls_countmem(LS_MEMFRAMES, oldsize, ls_framebytes(e));
+	}
+	
+	e->localsts[e->fndepth] = *st;
+	e->scopes[e->fndepth] = 0;
+	e->mods[e->fndepth] = mod;
+	e->fnframes[e->fndepth] = e->nframes;
+	++e->fndepth;
+}
+
+static void
+ls_popexecfn(ls_exec_t *e)
+{
+	ls_destroysymtab(&e->localsts[--e->fndepth]);
+}
+
+// unwinds the whole execution if its cancellation token has been raised, in
+// which case the calling executor routine must return immediately.
+static bool
+ls_checkcancel(ls_exec_t *e)
+{
+	if (!e->cancel || !e->cancel->raised)
+	{
+		return false;
+	}
+	
+	ls_unwindexec(e);
+	return true;
+}
+
+// drops every scope, function environment, frame and intermediate value, leaving
+// the execution finished.
+static void
+ls_unwindexec(ls_exec_t *e)
+{
+	while (e->fndepth)
+	{
+		ls_symtab_t *st = &e->localsts[e->fndepth - 1];
+		while (e->scopes[e->fndepth - 1])
+		{
+			ls_popsymscope(st, e->scopes[e->fndepth - 1]--);
+		}
+		ls_popexecfn(e);
+	}
+	
+	for (uint32_t i = 0; i < e->nvals; ++i)
+	{
+		ls_destroyval(&e->vals[i]);
+	}
+	
+	e->nvals = 0;
+	e->nframes = 0;
+	e->nloops = 0;
+	e->action = LS_NOACTION;
+	e->cancelled = true;
+}
+
+// builds the dispatch tables of the execution, substituting fused operations for
+// idioms that can be run without evaluating all of their nodes, and reads every
+// integer literal in advance. the operand types assumed by the fused operations
+// are guaranteed by semantic analysis.
+static void
+ls_fuseops(ls_exec_t *e)
+{
+	ls_module_t const *m = e->m;
+	
+	size_t nnodes = 0;
+	for (uint32_t i = 0; i < m->nmods; ++i)
+	{
+		nnodes += m->asts[i].nnodes;
+	}
+	
+	int64_t *ints = NULL;
+	uint8_t *ops = NULL;
+	ls_allocbatch_t allocs[] =
+	{
+		{(void **)&e->ops, m->nmods, sizeof(uint8_t *)},
+		{(void **)&e->ints, m->nmods, sizeof(int64_t *)},
+		{(void **)&ints, nnodes, sizeof(int64_t)},
+		{(void **)&ops, nnodes, sizeof(uint8_t)}
+	};
+	e->opbuf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	ls_countmem(LS_MEMAST, 0, ls_opbytes(m));
+	
+	for (uint32_t i = 0; i < m->nmods; ++i)
+	{
+		ls_lex_t const *l = &m->lexes[i];
+		ls_ast_t const *a = &m->asts[i];
+		
+		e->ops[i] = ops;
+		e->ints[i] = ints;
+		ops += a->nnodes;
+		ints += a->nnodes;
+		
+		for (uint32_t j = 0; j < a->nnodes; ++j)
+		{
+			bool lit = ls_isintlit(m, i, j);
+			e->ints[i][j] = lit ? ls_readtokint(m->data[i], l->toks[a->nodes[j].tok]) : 0;
+		}
+		
+		for (uint32_t j = 0; j < a->nnodes; ++j)
+		{
+			e->ops[i][j] = a->types[j];
+			
+			if (a->types[j] == LS_FOR && ls_iscountedloop(m, i, j))
+			{
+				e->ops[i][j] = LS_XFORCOUNT;
+			}
+			else if (a->types[j] >= LS_ELESS && a->types[j] <= LS_ENEQUAL)
+			{
+				if (ls_ismodzero(m, i, e->ints[i], j))
+				{
+					e->ops[i][j] = LS_XMODZERO;
+				}
+				else if (ls_isintlit(m, i, a->nodes[j].children[1]))
+				{
+					e->ops[i][j] = LS_XCMPIMM;
+				}
+			}
+		}
+	}
+}
+
+// the size of the dispatch tables of an execution of the module.
+static size_t
+ls_opbytes(ls_module_t const *m)
+{
+	size_t nnodes = 0;
+	for (uint32_t i = 0; i < m->nmods; ++i)
+	{
+		nnodes += m->asts[i].nnodes;
+	}
+	
+	return m->nmods * (sizeof(uint8_t *) + sizeof(int64_t *)) + nnodes * (sizeof(int64_t) + sizeof(uint8_t));
+}
+
+static bool
+ls_isintlit(ls_module_t const *m, uint32_t mod, uint32_t node)
+{
+	ls_ast_t const *a = &m->asts[mod];
+	return a->types[node] == LS_EATOM && m->lexes[mod].types[a->nodes[node].tok] == LS_LITINT;
+}
+
+// whether the node is an atom naming the identifier of the token.
+static bool
+ls_isident(ls_module_t const *m, uint32_t mod, uint32_t node, uint32_t tok)
+{
+	ls_lex_t const *l = &m->lexes[mod];
+	ls_ast_t const *a = &m->asts[mod];
+	
+	if (a->types[node] != LS_EATOM || l->types[a->nodes[node].tok] != LS_IDENT)
+	{
+		return false;
+	}
+	
+	ls_tok_t t0 = l->toks[a->nodes[node].tok], t1 = l->toks[tok];
+	return t0.len == t1.len && !memcmp(&m->data[mod][t0.pos], &m->data[mod][t1.pos], t0.len);
+}
+
+// a counted loop declares an int induction variable, compares it with a bound
+// and adds a step to it, the bound and step being literals or symbols.
+static bool
+ls_iscountedloop(ls_module_t const *m, uint32_t mod, uint32_t node)
+{
+	ls_lex_t const *l = &m->lexes[mod];
+	ls_ast_t const *a = &m->asts[mod];
+	
+	uint32_t ninit = a->nodes[node].children[0];
+	uint32_t ncond = a->nodes[node].children[1];
+	uint32_t ninc = a->nodes[node].children[2];
+	
+	if (a->types[ninit] != LS_LOCALDECL)
+	{
+		return false;
+	}
+	
+	uint32_t ntype = a->nodes[ninit].children[0];
+	if (l->types[a->nodes[ntype].tok] != LS_KWINT)
+	{
+		return false;
+	}
+	
+	if (a->types[ncond] < LS_ELESS || a->types[ncond] > LS_ENEQUAL)
+	{
+		return false;
+	}
+	
+	if (a->types[ninc] != LS_EADDASSIGN && a->types[ninc] != LS_ESUBASSIGN)
+	{
+		return false;
+	}
+	
+	uint32_t var = a->nodes[ninit].tok;
+	uint32_t nbound = a->nodes[ncond].children[1];
+	uint32_t nstep = a->nodes[ninc].children[1];
+	
+	return ls_isident(m, mod, a->nodes[ncond].children[0], var)
+		&& ls_isident(m, mod, a->nodes[ninc].children[0], var)
+		&& ls_isloopoperand(m, mod, nbound)
+		&& ls_isloopoperand(m, mod, nstep);
+}
+
+static bool
+ls_isloopoperand(ls_module_t const *m, uint32_t mod, uint32_t node)
+{
+	ls_ast_t const *a = &m->asts[mod];
+	if (a->types[node] != LS_EATOM)
+	{
+		return false;
+	}
+	
+	ls_toktype_t type = m->lexes[mod].types[a->nodes[node].tok];
+	return type == LS_LITINT || type == LS_IDENT;
+}
+
+// matches x % k == 0 and x % k != 0, for a non-zero literal k.
+static bool
+ls_ismodzero(ls_module_t const *m, uint32_t mod, int64_t const *ints, uint32_t node)
+{
+	ls_ast_t const *a = &m->asts[mod];
+	
+	if (a->types[node] != LS_EEQUAL && a->types[node] != LS_ENEQUAL)
+	{
+		return false;
+	}
+	
+	uint32_t nmod = a->nodes[node].children[0];
+	uint32_t nzero = a->nodes[node].children[1];
+	if (a->types[nmod] != LS_EMOD || !ls_isintlit(m, mod, nzero) || ints[nzero])
+	{
+		return false;
+	}
+	
+	uint32_t ndivisor = a->nodes[nmod].children[1];
+	return ls_isintlit(m, mod, ndivisor) && ints[ndivisor];
+}
+
+static bool
+ls_cmpint(ls_nodetype_t cmp, int64_t l, int64_t r)
+{
+	switch (cmp)
+	{
+	case LS_ELESS:
+		return l < r;
+	case LS_ELEQUAL:
+		return l <= r;
+	case LS_EGREATER:
+		return l > r;
+	case LS_EGREQUAL:
+		return l >= r;
+	case LS_EEQUAL:
+		return l == r;
+	default: // not equal.
+		return l != r;
+	}
+}
+
+// the size of the function environment, frame, value and counted loop stacks.
+static size_t
+ls_framebytes(ls_exec_t const *e)
+{
+	size_t fnbytes = e->fndepthcap * (sizeof(ls_symtab_t) + sizeof(uint16_t) + 2 * sizeof(uint32_t));
+	size_t framebytes = e->framecap * sizeof(ls_execframe_t);
+	size_t valbytes = e->valcap * sizeof(ls_val_t);
+	size_t loopbytes = e->loopcap * sizeof(ls_countedloop_t);
+	
+	return fnbytes + framebytes + valbytes + loopbytes;
+}
+
+// the node is interpreted in the module of the innermost function environment.
+// pushing a frame may move the frame stack, so executor routines must not use
+// their frame pointer after calling this.
+static void
+ls_pushexecnode(ls_exec_t *e, uint32_t node)
+{
+	if (e->nframes >= e->framecap)
+	{
+		size_t oldsize = ls_framebytes(e);
+		e->framecap *= 2;
+		e->frames = ls_reallocarray(e->frames, e->framecap, sizeof(ls_execframe_t));
+		ls_countmem(LS_MEMFRAMES, oldsize, ls_framebytes(e));
+	}
+	
+	e->frames[e->nframes++] = (ls_execframe_t)
+	{
+		.node = node
+	};
+}
+
+// finishes the current frame, leaving its result on the value stack.
+static void
+ls_retexecnode(ls_exec_t *e, ls_val_t v)
+{
+	--e->nframes;
+	ls_pushval(e, v);
+}
+
+// evaluates the children of the frame's node in [first, last) onto the value
+// stack, one per stage. atoms never suspend, so they are evaluated in place
+// rather than given their own frame. returns true if a child frame was pushed,
+// in which case the routine must return and wait to be stepped again.
+static bool
+ls_execnext(ls_exec_t *e, ls_execframe_t *f, uint32_t first, uint32_t last)
+{
+	ls_ast_t const *a = &e->m->asts[e->mods[e->fndepth - 1]];
+	
+	while (first + f->stage < last)
+	{
+		uint32_t child = a->nodes[f->node].children[first + f->stage++];
+		if (a->types[child] != LS_EATOM)
+		{
+			ls_pushexecnode(e, child);
+			return true;
+		}
+		
+		ls_pushval(e, ls_atomval(e, child));
+	}
+	
+	return false;
+}
+
+static void
+ls_pushval(ls_exec_t *e, ls_val_t v)
+{
+	if (e->nvals >= e->valcap)
+	{
+		size_t oldsize = ls_framebytes(e);
+		e->valcap *= 2;
+		e->vals = ls_reallocarray(e->vals, e->valcap, sizeof(ls_val_t));
+		ls_countmem(LS_MEMFRAMES, oldsize, ls_framebytes(e));
+	}
+	
+	e->vals[e->nvals++] = v;
+}
+
+static ls_val_t
+ls_popval(ls_exec_t *e)
+{
+	return e->vals[--e->nvals];
+}
+
+static ls_val_t
+ls_atomval(ls_exec_t *e, uint32_t node)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	
+	ls_lex_t const *l = &e->m->lexes[mod];
+	ls_ast_t const *a = &e->m->asts[mod];
+	
+	switch (l->types[a->nodes[node].tok])
+	{
+	case LS_IDENT:
+	{
+		ls_tok_t tok = l->toks[a->nodes[node].tok];
+		
+		char sym[LS_MAXIDENT + 1] = {0};
+		ls_readtokraw(sym, e->m->data[mod], tok);
+		
+		ls_symtab_t *st = &e->localsts[e->fndepth - 1];
+		
+		int64_t decl = ls_findsym(st, sym);
+		if (decl != -1)
+		{
+			return ls_copyval(&st->vals[decl]);
+		}
+		
+		decl = ls_findsym(&e->globalst, sym);
+		return ls_copyval(&e->globalst.vals[decl]);
+	}
+	case LS_LITSTR:
+	{
+		ls_tok_t tok = l->toks[a->nodes[node].tok];
+		
+		char str[LS_MAXSTRING + 1] = {0};
+		ls_readtokstr(str, e->m->data[mod], tok);
+		
+		return ls_newexecstr(e, str, strlen(str));
+	}
+	case LS_LITINT:
+		return (ls_val_t)
+		{
+			.type = LS_INT,
+			.data.int_ = e->ints[mod][node]
+		};
+	case LS_LITREAL:
+	{
+		ls_tok_t tok = l->toks[a->nodes[node].tok];
+		return (ls_val_t)
+		{
+			.type = LS_REAL,
+			.data.real = ls_readtokreal(e->m->data[mod], tok)
+		};
+	}
+	case LS_KWTRUE:
+		return (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = true
+		};
+	case LS_KWFALSE:
+		return (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = false
+		};
+	default:
+		return (ls_val_t){0};
+	}
+}
+
+// console output is collected per execution and handed to the host in blocks.
+static void
+ls_execcwrite(ls_exec_t *e, char const *buf, size_t len)
+{
+	if (e->ncout + len > sizeof(e->cout))
+	{
+		ls_execcflush(e);
+	}
+	
+	if (len >= sizeof(e->cout))
+	{
+		ls_cwrite(buf, len);
+		return;
+	}
+	
+	ls_memcpy(&e->cout[e->ncout], buf, len);
+	e->ncout += len;
+	
+	if (ls_conf.clinebuf && memchr(buf, '\n', len))
+	{
+		ls_execcflush(e);
+	}
+}
+
+static void
+ls_execcflush(ls_exec_t *e)
+{
+	if (e->ncout)
+	{
+		ls_cwrite(e->cout, e->ncout);
+		e->ncout = 0;
+	}
+}
+
+// file descriptors are not owned by their readers, which only buffer what has
+// been read from them.
+static ls_fdreader_t *
+ls_execreader(ls_exec_t *e, int32_t fd)
+{
+	for (size_t i = 0; i < e->nrds; ++i)
+	{
+		if (e->rds[i].fd == fd)
+		{
+			return &e->rds[i];
+		}
+	}
+	
+	if (e->nrds >= e->rdcap)
+	{
+		e->rdcap *= 2;
+		e->rds = ls_reallocarray(e->rds, e->rdcap, sizeof(ls_fdreader_t));
+	}
+	
+	e->rds[e->nrds] = (ls_fdreader_t)
+	{
+		.buf = ls_malloc(LS_FDBUFSIZE),
+		.fd = fd
+	};
+	return &e->rds[e->nrds++];
+}
+
+// returns false once no more data can be read, whether due to end of file or
+// an error.
+static bool
+ls_fillreader(ls_exec_t *e, ls_fdreader_t *rd)
+{
+	if (rd->eof)
+	{
+		return false;
+	}
+	
+	// pending output may be a prompt for the data being read.
+	ls_flushwriters(e);
+	
+	ssize_t n;
+	do
+	{
+		n = read(rd->fd, rd->buf, LS_FDBUFSIZE);
+	} while (n == -1 && errno == EINTR);
+	
+	if (n == -1)
+	{
+		fprintf(e->logfp, LS_ERR "failure on read() of file descriptor %d!\n", rd->fd);
+	}
+	
+	if (n <= 0)
+	{
+		rd->eof = true;
+		return false;
+	}
+	
+	rd->pos = 0;
+	rd->len = n;
+	return true;
+}
+
+static ls_fdwriter_t *
+ls_execwriter(ls_exec_t *e, int32_t fd)
+{
+	for (size_t i = 0; i < e->nwrs; ++i)
+	{
+		if (e->wrs[i].fd == fd)
+		{
+			return &e->wrs[i];
+		}
+	}
+	
+	if (e->nwrs >= e->wrcap)
+	{
+		e->wrcap *= 2;
+		e->wrs = ls_reallocarray(e->wrs, e->wrcap, sizeof(ls_fdwriter_t));
+	}
+	
+	// terminals are flushed on newlines, like stdio does.
+	e->wrs[e->nwrs] = (ls_fdwriter_t)
+	{
+		.buf = ls_malloc(LS_FDBUFSIZE),
+		.fd = fd,
+		.linebuf = isatty(fd)
+	};
+	return &e->wrs[e->nwrs++];
+}
+
+// data which doesn't fit in the buffer is written together with the buffered
+// data in one writev() call.
+static void
+ls_writewriter(ls_exec_t *e, ls_fdwriter_t *wr, char const *data, size_t len)
+{
+	if (wr->len + len <= LS_FDBUFSIZE)
+	{
+		ls_memcpy(&wr->buf[wr->len], data, len);
+		wr->len += len;
+		
+		if (wr->linebuf && memchr(data, '\n', len))
+		{
+			ls_flushwriter(e, wr);
+		}
+		return;
+	}
+	
+	struct iovec iov[] =
+	{
+		{wr->buf, wr->len},
+		{(void *)data, len}
+	};
+	
+	ls_writeiov(e, wr->fd, iov, ARRSIZE(iov));
+	wr->len = 0;
+}
+
+static void
+ls_flushwriter(ls_exec_t *e, ls_fdwriter_t *wr)
+{
+	if (wr->len)
+	{
+		struct iovec iov = {wr->buf, wr->len};
+		ls_writeiov(e, wr->fd, &iov, 1);
+		wr->len = 0;
+	}
+}
+
+static void
+ls_flushwriters(ls_exec_t *e)
+{
+	for (size_t i = 0; i < e->nwrs; ++i)
+	{
+		ls_flushwriter(e, &e->wrs[i]);
+	}
+}
+
+// writes out all of the data, modifying iov to handle partial writes.
+static void
+ls_writeiov(ls_exec_t *e, int32_t fd, struct iovec *iov, int niov)
+{
+	while (niov)
+	{
+		ssize_t n = writev(fd, iov, niov);
+		if (n == -1 && errno == EINTR)
+		{
+			continue;
+		}
+		else if (n == -1)
+		{
+			fprintf(e->logfp, LS_ERR "failure on writev() of file descriptor %d!\n", fd);
+			return;
+		}
+		
+		while (niov && (size_t)n >= iov->iov_len)
+		{
+			n -= iov->iov_len;
+			++iov;
+			--niov;
+		}
+		
+		if (niov)
+		{
+			iov->iov_base = (char *)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+}
+
+// discards the reader and writer of a file descriptor which is being closed.
+static void
+ls_dropfd(ls_exec_t *e, int32_t fd)
+{
+	for (size_t i = 0; i < e->nrds; ++i)
+	{
+		if (e->rds[i].fd == fd)
+		{
+			ls_free(e->rds[i].buf);
+			e->rds[i] = e->rds[--e->nrds];
+			break;
+		}
+	}
+	
+	for (size_t i = 0; i < e->nwrs; ++i)
+	{
+		if (e->wrs[i].fd == fd)
+		{
+			ls_flushwriter(e, &e->wrs[i]);
+			ls_free(e->wrs[i].buf);
+			e->wrs[i] = e->wrs[--e->nwrs];
+			break;
+		}
+	}
+}
+
+// returns NULL if the space cannot be allocated, leaving the old space intact.
+static char *
+ls_reservetmp(ls_exec_t *e, size_t cap)
+{
+	if (cap > e->tmpcap)
+	{
+		size_t newcap = e->tmpcap;
+		while (cap > newcap)
+		{
+			newcap *= 2;
+		}
+		
+		char *tmp = ls_realloc(e->tmp, newcap);
+		if (!tmp)
+		{
+			return NULL;
+		}
+		
+		e->tmp = tmp;
+		e->tmpcap = newcap;
+	}
+	
+	return e->tmp;
+}
+
+static int
+ls_cmpstr(ls_val_t const *a, ls_val_t const *b)
+{
+	size_t alen = ls_strlen(a), blen = ls_strlen(b);
+	
+	int cmp = memcmp(ls_strptr(a), ls_strptr(b), alen < blen ? alen : blen);
+	if (cmp)
+	{
+		return cmp;
+	}
+	
+	return alen < blen ? -1 : alen > blen;
+}
 
+static ls_val_t
+ls_catstr(ls_exec_t *e, ls_val_t const *a, ls_val_t const *b)
+{
+	size_t alen = ls_strlen(a), blen = ls_strlen(b);
+	
+	ls_val_t out;
+	char *data = ls_allocexecstr(e, &out, alen + blen);
+	ls_memcpy(data, ls_strptr(a), alen);
+	ls_memcpy(&data[alen], ls_strptr(b), blen);
+	
+	return out;
+}
+
+static ls_val_t
+ls_sysprint(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	ls_fdwriter_t *wr = ls_execwriter(e, args[0].data.int_);
+	ls_writewriter(e, wr, ls_strptr(&args[1]), ls_strlen(&args[1]));
+	
+	return ls_defaultval(LS_VOID);
+}
+
+static ls_val_t
+ls_syscprint(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	ls_execcwrite(e, ls_strptr(&args[0]), ls_strlen(&args[0]));
+	return ls_defaultval(LS_VOID);
+}
+
+// lines of any length are read, the trailing newline is not included. at the
+// end of the file, any remaining unterminated line is returned, and afterwards
+// only empty strings.
 static ls_val_t
 ls_sysreadln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
 {
+	ls_fdreader_t *rd = ls_execreader(e, args[0].data.int_);
+	
+	size_t len = 0;
+	for (;;)
+	{
+		if (rd->pos >= rd->len && !ls_fillreader(e, rd))
+		{
+			break;
+		}
+		
+		char const *p = &rd->buf[rd->pos];
+		char const *nl = memchr(p, '\n', rd->len - rd->pos);
+		size_t n = nl ? (size_t)(nl - p) : rd->len - rd->pos;
+		
+		// most lines are entirely buffered and can be taken directly.
+		if (nl && !len)
+		{
+			rd->pos += n + 1;
+			return ls_newexecstr(e, p, n);
+		}
+		
+		char *tmp = ls_reservetmp(e, len + n);
+		ls_memcpy(&tmp[len], p, n);
+		len += n;
+		rd->pos += n;
+		
+		if (nl)
+		{
+			++rd->pos;
+			break;
+		}
+	}
+	
+	return ls_newexecstr(e, e->tmp, len);
+}
+
+// allows iterating over all lines of a file descriptor, i.e. calling readln
+// while hasln returns true.
+static ls_val_t
+ls_syshasln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	ls_fdreader_t *rd = ls_execreader(e, args[0].data.int_);
+	
+	return (ls_val_t)
+	{
+		.type = LS_BOOL,
+		.data.bool_ = rd->pos < rd->len || ls_fillreader(e, rd)
+	};
+}
+
+static ls_val_t
+ls_sysflush(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	ls_fdwriter_t *wr = ls_execwriter(e, args[0].data.int_);
+	ls_flushwriter(e, wr);
+	
+	return ls_defaultval(LS_VOID);
+}
+
+static ls_val_t
+ls_syscreadln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	(void)args;
+	
+	// prompts must be visible before waiting on input.
+	ls_execcflush(e);
+	
 	char buf[LS_MAXSTRING + 1] = {0};
 	size_t len = 0;
 	
 	while (len < LS_MAXSTRING)
 	{
-		char ch;
-		if (read(args[0].data.int_, &ch, 1) == -1)
+		if (e->cinpos >= e->ncin)
 		{
-			fprintf(e->logfp, LS_ERR "failure on read() in system readln!\n");
-			return ls_defaultval(LS_STRING);
+			int64_t n = ls_cread(e->cin, sizeof(e->cin));
+			if (n == LS_CIGNORE && e->cancel && e->cancel->raised)
+			{
+				// the execution unwinds at the next cancellation point.
+				return ls_defaultval(LS_STRING);
+			}
+			else if (n == LS_CIGNORE)
+			{
+				// the hook has already blocked, as required by ls_conf.
+				continue;
+			}
+			else if (n == LS_CERR || n == 0)
+			{
+				if (len)
+				{
+					break;
+				}
+				
+				fprintf(e->logfp, LS_ERR "failure on console read in system creadln!\n");
+				return ls_defaultval(LS_STRING);
+			}
+			
+			e->cinpos = 0;
+			e->ncin = n;
 		}
 		
-		if (ch == '\n')
+		char const *p = &e->cin[e->cinpos];
+		char const *nl = memchr(p, '\n', e->ncin - e->cinpos);
+		
+		size_t n = nl ? (size_t)(nl - p) : e->ncin - e->cinpos;
+		n = n > LS_MAXSTRING - len ? LS_MAXSTRING - len : n;
+		
+		ls_memcpy(&buf[len], p, n);
+		len += n;
+		e->cinpos += n;
+		
+		if (nl && &e->cin[e->cinpos] == nl)
 		{
+			++e->cinpos;
 			break;
 		}
-		
-		buf[len++] = ch;
 	}
 	
-	return (ls_val_t)
-	{
-		.type = LS_STRING,
-		.data.string = ls_strdup(buf)
-	};
+	return ls_newexecstr(e, buf, len);
 }
 
+// runs the command through the shell, capturing all of its standard output.
+// the exit code and output are kept until the next command and are retrieved
+// with shellrc and shellout. returns false if the command could not be run.
 static ls_val_t
-ls_syscreadln(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+ls_sysshell(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
 {
-	(void)args;
+	ls_val_t failure =
+	{
+		.type = LS_BOOL,
+		.data.bool_ = false
+	};
 	
-	char buf[LS_MAXSTRING + 1] = {0};
-	size_t len = 0;
+	ls_destroyval(&e->shellout);
+	e->shellout = ls_defaultval(LS_STRING);
+	e->shellrc = -1;
 	
-	while (len < LS_MAXSTRING)
+	// the pipe is close-on-exec so that commands spawned concurrently by other
+	// threads cannot inherit it and hold it open. the command still gets its
+	// write end as stdout.
+	int pipefds[2];
+	if (pipe2(pipefds, O_CLOEXEC))
+	{
+		fprintf(e->logfp, LS_ERR "failed on pipe2() in system shell!\n");
+		return failure;
+	}
+	
+	posix_spawn_file_actions_t actions;
+	if (posix_spawn_file_actions_init(&actions))
+	{
+		fprintf(e->logfp, LS_ERR "failed on posix_spawn_file_actions_init() in system shell!\n");
+		close(pipefds[0]);
+		close(pipefds[1]);
+		return failure;
+	}
+	
+	if (posix_spawn_file_actions_addclose(&actions, pipefds[0])
+		|| posix_spawn_file_actions_adddup2(&actions, pipefds[1], STDOUT_FILENO)
+		|| posix_spawn_file_actions_addclose(&actions, pipefds[1]))
+	{
+		fprintf(e->logfp, LS_ERR "failed to set up file actions in system shell!\n");
+		posix_spawn_file_actions_destroy(&actions);
+		close(pipefds[0]);
+		close(pipefds[1]);
+		return failure;
+	}
+	
+	// the command shares our file descriptors and must see output in order.
+	ls_flushwriters(e);
+	
+	pid_t pid;
+	char *cmd = ls_cstr(&args[0]);
+	char *argv[] = {"sh", "-c", cmd, NULL};
+	int rc = posix_spawn(&pid, "/bin/sh", &actions, NULL, argv, environ);
+	
+	ls_free(cmd);
+	posix_spawn_file_actions_destroy(&actions);
+	close(pipefds[1]);
+	
+	if (rc)
+	{
+		fprintf(e->logfp, LS_ERR "failed on posix_spawn() in system shell!\n");
+		close(pipefds[0]);
+		return failure;
+	}
+	
+	size_t len = 0;
+	for (;;)
 	{
-		int c = ls_conf.cget();
-		if (c == LS_CIGNORE)
+		char *out = ls_reservetmp(e, len + LS_FDBUFSIZE);
+		
+		ssize_t n = read(pipefds[0], &out[len], LS_FDBUFSIZE);
+		if (n == -1 && errno == EINTR)
 		{
 			continue;
 		}
-		else if (c == LS_CERR)
+		else if (n == -1)
 		{
-			fprintf(e->logfp, LS_ERR "failure on cget() in system creadln!\n");
-			return ls_defaultval(LS_STRING);
+			fprintf(e->logfp, LS_ERR "failed on read() in system shell!\n");
+			break;
 		}
-		
-		if (c == '\n')
+		else if (n == 0)
 		{
 			break;
 		}
 		
-		buf[len++] = c;
+		len += n;
+	}
+	
+	close(pipefds[0]);
+	
+	int status;
+	while (waitpid(pid, &status, 0) == -1)
+	{
+		if (errno != EINTR)
+		{
+			fprintf(e->logfp, LS_ERR "failed on waitpid() in system shell!\n");
+			return failure;
+		}
 	}
 	
+	ls_destroyval(&e->shellout);
+	e->shellout = ls_newexecstr(e, e->tmp, len);
+	e->shellrc = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+	
 	return (ls_val_t)
 	{
-		.type = LS_STRING,
-		.data.string = ls_strdup(buf)
+		.type = LS_BOOL,
+		.data.bool_ = true
 	};
 }
 
 static ls_val_t
-ls_sysshell(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+ls_sysshellrc(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
 {
-	int64_t outdecl = ls_findsym(&e->localsts[e->fndepth - 1], "__out");
-	if (outdecl == -1)
+	(void)args;
+	
+	return (ls_val_t)
 	{
-		fprintf(e->logfp, LS_ERR "could not find local __out when invoking system shell!\n");
-		return (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = false
-		};
-	}
+		.type = LS_INT,
+		.data.int_ = e->shellrc
+	};
+}
+
+static ls_val_t
+ls_sysshellout(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	(void)args;
+	
+	return ls_copyval(&e->shellout);
+}
+
+// modes are "r", "w", "a", "r+", "w+" and "a+", with the same meaning as for
+// fopen(). returns -1 on failure. the returned handle is a file descriptor, so
+// it is also used with print, readln and hasln.
+static ls_val_t
+ls_sysfopen(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	static struct
+	{
+		char const *mode;
+		int flags;
+	} const modes[] =
+	{
+		{"r", O_RDONLY},
+		{"w", O_WRONLY | O_CREAT | O_TRUNC},
+		{"a", O_WRONLY | O_CREAT | O_APPEND},
+		{"r+", O_RDWR},
+		{"w+", O_RDWR | O_CREAT | O_TRUNC},
+		{"a+", O_RDWR | O_CREAT | O_APPEND}
+	};
 	
-	ls_val_t *vout = &e->localsts[e->fndepth - 1].vals[outdecl];
-	if (vout->type != LS_STRING)
+	ls_val_t out =
 	{
-		fprintf(e->logfp, LS_ERR "local __out was not string when invoking system shell!\n");
-		return (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = false
-		};
-	}
+		.type = LS_INT,
+		.data.int_ = -1
+	};
 	
-	int64_t rcdecl = ls_findsym(&e->localsts[e->fndepth - 1], "__rc");
-	if (rcdecl == -1)
+	char *path = ls_cstr(&args[0]), *mode = ls_cstr(&args[1]);
+	
+	size_t i = 0;
+	while (i < ARRSIZE(modes) && strcmp(mode, modes[i].mode))
 	{
-		fprintf(e->logfp, LS_ERR "could not find local __rc when invoking system shell!\n");
-		return (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = false
-		};
+		++i;
 	}
 	
-	ls_val_t *vrc = &e->localsts[e->fndepth - 1].vals[rcdecl];
-	if (vrc->type != LS_INT)
+	if (i == ARRSIZE(modes))
 	{
-		fprintf(e->logfp, LS_ERR "local __rc was not int when invoking system shell!\n");
-		return (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = false
-		};
+		fprintf(e->logfp, LS_ERR "invalid mode %s in system fopen!\n", mode);
 	}
-	
-	FILE *fp = popen(args[0].data.string, "r");
-	if (!fp)
+	else
 	{
-		fprintf(e->logfp, LS_ERR "failed on popen() in system shell!\n");
-		return (ls_val_t)
+		out.data.int_ = open(path, modes[i].flags | O_CLOEXEC, 0644);
+		if (out.data.int_ == -1)
 		{
-			.type = LS_BOOL,
-			.data.bool_ = false
-		};
+			fprintf(e->logfp, LS_ERR "failed to open %s in system fopen!\n", path);
+		}
 	}
 	
-	char buf[LS_MAXSTRING + 1] = {0};
+	ls_free(path);
+	ls_free(mode);
+	return out;
+}
+
+// reads up to the given number of bytes, returning fewer only at the end of the
+// file.
+static ls_val_t
+ls_sysfread(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	ls_fdreader_t *rd = ls_execreader(e, args[0].data.int_);
+	
+	// the count is chosen by the script, so space is only reserved for data which
+	// has actually been read.
+	size_t cap = args[1].data.int_ > 0 ? args[1].data.int_ : 0;
 	size_t len = 0;
 	
-	while (len < LS_MAXSTRING)
+	while (len < cap)
 	{
-		int ch = fgetc(fp);
-		if (ch == EOF)
+		if (rd->pos >= rd->len && !ls_fillreader(e, rd))
 		{
 			break;
 		}
 		
-		buf[len++] = ch;
+		size_t n = rd->len - rd->pos;
+		n = n > cap - len ? cap - len : n;
+		
+		char *buf = ls_reservetmp(e, len + n);
+		if (!buf)
+		{
+			fprintf(e->logfp, LS_ERR "failed to allocate %zu bytes in system fread!\n", len + n);
+			return ls_defaultval(LS_STRING);
+		}
+		
+		ls_memcpy(&buf[len], &rd->buf[rd->pos], n);
+		len += n;
+		rd->pos += n;
 	}
 	
-	vrc->data.int_ = pclose(fp);
+	return ls_newexecstr(e, e->tmp, len);
+}
+
+// buffered output is written before closing.
+static ls_val_t
+ls_sysfclose(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	ls_dropfd(e, args[0].data.int_);
 	
-	ls_destroyval(vout);
-	vout->data.string = ls_strdup(buf);
+	bool ok = !close(args[0].data.int_);
+	if (!ok)
+	{
+		fprintf(e->logfp, LS_ERR "failure on close() in system fclose!\n");
+	}
 	
 	return (ls_val_t)
 	{
 		.type = LS_BOOL,
-		.data.bool_ = true
+		.data.bool_ = ok
+	};
+}
+
+// the file is mapped rather than read, and stays mapped for as long as the
+// returned string (or any copy or part of it) is alive.
+static ls_val_t
+ls_sysfmap(ls_exec_t *e, ls_val_t args[LS_MAXSYSARGS])
+{
+	char *path = ls_cstr(&args[0]);
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+	{
+		fprintf(e->logfp, LS_ERR "failed to open %s in system fmap!\n", path);
+		ls_free(path);
+		return ls_defaultval(LS_STRING);
+	}
+	
+	struct stat stat;
+	if (fstat(fd, &stat) || !stat.st_size)
+	{
+		close(fd);
+		ls_free(path);
+		return ls_defaultval(LS_STRING);
+	}
+	
+	if ((uint64_t)stat.st_size > UINT32_MAX)
+	{
+		fprintf(e->logfp, LS_ERR "%s is too large for system fmap!\n", path);
+		close(fd);
+		ls_free(path);
+		return ls_defaultval(LS_STRING);
+	}
+	
+	void *data = mmap(NULL, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		fprintf(e->logfp, LS_ERR "failed on mmap() of %s in system fmap!\n", path);
+		ls_free(path);
+		return ls_defaultval(LS_STRING);
+	}
+	ls_free(path);
+	
+	ls_strbuf_t *buf = ls_malloc(sizeof(ls_strbuf_t));
+	*buf = (ls_strbuf_t)
+	{
+		.data = data,
+		.len = stat.st_size,
+		.refs = 1,
+		.kind = LS_MAPSTR
+	};
+	ls_countmem(LS_MEMSTRINGS, 0, sizeof(ls_strbuf_t) + stat.st_size);
+	
+	return (ls_val_t)
+	{
+		.type = LS_STRING,
+		.data.string =
+		{
+			.buf = buf,
+			.len = stat.st_size
+		}
 	};
 }
 
-// it is the caller's responsibility to setup and destroy the new function
-// environment and set arguments to their passed values.
-static ls_execaction_t
-ls_execfuncdecl(ls_val_t *out, ls_exec_t *e, uint32_t node)
+// it is the caller's responsibility to setup the new function environment and
+// set arguments to their passed values. the environment is destroyed once the
+// function finishes.
+static void
+ls_execfuncdecl(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_lex_t const *l = &e->m->lexes[mod];
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t ntype = a->nodes[node].children[0];
-	uint32_t nbody = a->nodes[node].children[2];
+	uint32_t ntype = a->nodes[f->node].children[0];
+	uint32_t nbody = a->nodes[f->node].children[2];
+	
+	if (!f->stage++)
+	{
+		ls_pushexecnode(e, nbody);
+		return;
+	}
 	
-	ls_execaction_t action = ls_execfns[a->types[nbody]](out, e, nbody);
-	if (action != LS_RETURNVALUE)
+	ls_val_t v = ls_popval(e);
+	if (e->action != LS_RETURNVALUE)
 	{
+		ls_destroyval(&v);
+		
 		ls_toktype_t typetok = l->types[a->nodes[ntype].tok];
 		ls_primtype_t primtype = ls_toktoprim[typetok];
-		*out = ls_defaultval(primtype);
+		v = ls_defaultval(primtype);
 	}
 	
-	return LS_NOACTION;
+	e->action = LS_NOACTION;
+	ls_popexecfn(e);
+	ls_retexecnode(e, v);
 }
 
-static ls_execaction_t
-ls_execlocaldecl(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execlocaldecl(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	uint32_t scope = e->scopes[e->fndepth - 1];
 	
 	ls_lex_t const *l = &e->m->lexes[mod];
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t ntype = a->nodes[node].children[0];
-	uint32_t nval = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_tok_t tok = l->toks[a->nodes[node].tok];
+	uint32_t ntype = a->nodes[f->node].children[0];
+	
+	ls_tok_t tok = l->toks[a->nodes[f->node].tok];
 	char sym[LS_MAXIDENT + 1] = {0};
 	ls_readtokraw(sym, e->m->data[mod], tok);
 	
 	ls_toktype_t typetok = l->types[a->nodes[ntype].tok];
 	ls_primtype_t primtype = ls_toktoprim[typetok];
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nval]](&v, e, nval);
-	
 	ls_symtab_t *st = &e->localsts[e->fndepth - 1];
-	ls_pushsym(st, ls_strdup(sym), primtype, mod, node, scope);
-	st->vals[st->nsyms - 1] = v;
+	ls_pushsym(st, ls_strdup(sym), primtype, mod, f->node, scope);
+	st->vals[st->nsyms - 1] = ls_popval(e);
+	ls_settlestr(&st->vals[st->nsyms - 1]);
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
 }
 
-static ls_execaction_t
-ls_execreturn(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execreturn(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	if (!a->nodes[node].nchildren)
+	if (!a->nodes[f->node].nchildren)
 	{
-		*out = ls_defaultval(LS_VOID);
-		return LS_RETURNVALUE;
+		e->action = LS_RETURNVALUE;
+		ls_retexecnode(e, ls_defaultval(LS_VOID));
+		return;
 	}
 	
-	uint32_t nval = a->nodes[node].children[0];
-	
-	ls_execfns[a->types[nval]](out, e, nval);
-	return LS_RETURNVALUE;
-}
-
-static ls_execaction_t
-ls_execctree(ls_val_t *out, ls_exec_t *e, uint32_t node)
-{
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t ncond = a->nodes[node].children[0];
-	uint32_t ntruebranch = a->nodes[node].children[1];
-	uint32_t nfalsebranch = a->nodes[node].nchildren == 3 ? a->nodes[node].children[2] : 0;
-	
-	ls_val_t vcond = {0};
-	ls_execfns[a->types[ncond]](&vcond, e, ncond);
-	
-	if (vcond.data.bool_)
-	{
-		++e->scopes[e->fndepth - 1];
-		ls_execaction_t action = ls_execfns[a->types[ntruebranch]](out, e, ntruebranch);
-		ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-		return action;
-	}
-	else if (nfalsebranch)
+	if (ls_execnext(e, f, 0, 1))
 	{
-		++e->scopes[e->fndepth - 1];
-		ls_execaction_t action = ls_execfns[a->types[nfalsebranch]](out, e, nfalsebranch);
-		ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-		return action;
+		return;
 	}
 	
-	return LS_NOACTION;
+	e->action = LS_RETURNVALUE;
+	ls_retexecnode(e, ls_popval(e));
 }
 
-static ls_execaction_t
-ls_execwhile(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execctree(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
-	++e->scopes[e->fndepth - 1];
-	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t ncond = a->nodes[node].children[0];
-	uint32_t nbody = a->nodes[node].children[1];
+	uint32_t ntruebranch = a->nodes[f->node].children[1];
+	uint32_t nfalsebranch = a->nodes[f->node].nchildren == 3 ? a->nodes[f->node].children[2] : 0;
 	
-	ls_val_t vcond = {0};
-	while (ls_execfns[a->types[ncond]](&vcond, e, ncond), vcond.data.bool_)
+	switch (f->stage)
 	{
-		ls_val_t v = {0};
-		ls_execaction_t action = ls_execfns[a->types[nbody]](&v, e, nbody);
-		if (action == LS_RETURNVALUE)
+	case 0:
+		ls_execnext(e, f, 0, 1);
+		return;
+	case 1:
+	{
+		ls_val_t vcond = ls_popval(e);
+		if (vcond.data.bool_)
 		{
-			*out = v;
-			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-			return LS_RETURNVALUE;
+			++f->stage;
+			++e->scopes[e->fndepth - 1];
+			ls_pushexecnode(e, ntruebranch);
 		}
-		
-		ls_destroyval(&v);
-		if (action == LS_STOPITER)
+		else if (nfalsebranch)
 		{
-			break;
+			++f->stage;
+			++e->scopes[e->fndepth - 1];
+			ls_pushexecnode(e, nfalsebranch);
+		}
+		else
+		{
+			ls_retexecnode(e, (ls_val_t){0});
 		}
+		return;
+	}
+	default:
+		// the branch's action is left for the enclosing nodes to handle.
+		ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+		ls_retexecnode(e, ls_popval(e));
+		return;
 	}
-	
-	ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execfor(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execwhile(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
-	++e->scopes[e->fndepth - 1];
-	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t ninit = a->nodes[node].children[0];
-	uint32_t ncond = a->nodes[node].children[1];
-	uint32_t ninc = a->nodes[node].children[2];
-	uint32_t nbody = a->nodes[node].children[3];
-	
-	ls_val_t vinit = {0};
-	ls_execfns[a->types[ninit]](&vinit, e, ninit);
-	ls_destroyval(&vinit);
+	uint32_t ncond = a->nodes[f->node].children[0];
+	uint32_t nbody = a->nodes[f->node].children[1];
 	
-	ls_val_t vcond = {0};
-	while (ls_execfns[a->types[ncond]](&vcond, e, ncond), vcond.data.bool_)
+	switch (f->stage)
 	{
-		ls_val_t v = {0};
-		ls_execaction_t action = ls_execfns[a->types[nbody]](&v, e, nbody);
-		if (action == LS_RETURNVALUE)
+	case 0:
+		++e->scopes[e->fndepth - 1];
+		break;
+	case 1:
+	{
+		ls_val_t vcond = ls_popval(e);
+		if (!vcond.data.bool_)
 		{
-			*out = v;
 			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-			return LS_RETURNVALUE;
-		}
-		
-		ls_destroyval(&v);
-		if (action == LS_STOPITER)
-		{
-			break;
+			ls_retexecnode(e, (ls_val_t){0});
+			return;
 		}
 		
-		ls_execfns[a->types[ninc]](&v, e, ninc);
-		ls_destroyval(&v);
+		f->stage = 2;
+		ls_pushexecnode(e, nbody);
+		return;
 	}
-	
-	ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-	return LS_NOACTION;
-}
-
-static ls_execaction_t
-ls_execbreak(ls_val_t *out, ls_exec_t *e, uint32_t node)
-{
-	(void)out;
-	(void)e;
-	(void)node;
-	
-	return LS_STOPITER;
-}
-
-static ls_execaction_t
-ls_execcontinue(ls_val_t *out, ls_exec_t *e, uint32_t node)
-{
-	(void)out;
-	(void)e;
-	(void)node;
-	
-	return LS_NEXTITER;
-}
-
-static ls_execaction_t
-ls_execblock(ls_val_t *out, ls_exec_t *e, uint32_t node)
-{
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	++e->scopes[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	for (uint32_t i = 0; i < a->nodes[node].nchildren; ++i)
+	default:
 	{
-		uint32_t nstmt = a->nodes[node].children[i];
-		
-		ls_val_t v = {0};
-		ls_execaction_t action = ls_execfns[a->types[nstmt]](&v, e, nstmt);
-		if (action == LS_RETURNVALUE)
+		ls_val_t v = ls_popval(e);
+		if (e->action == LS_RETURNVALUE)
 		{
-			*out = v;
 			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-			return LS_RETURNVALUE;
+			ls_retexecnode(e, v);
+			return;
 		}
 		
 		ls_destroyval(&v);
-		if (action == LS_NEXTITER)
+		if (e->action == LS_STOPITER)
 		{
+			e->action = LS_NOACTION;
 			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-			return LS_NEXTITER;
+			ls_retexecnode(e, (ls_val_t){0});
+			return;
 		}
-		else if (action == LS_STOPITER)
+		
+		e->action = LS_NOACTION;
+		if (ls_checkcancel(e))
 		{
-			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-			return LS_STOPITER;
+			return;
 		}
+		break;
+	}
 	}
 	
-	ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
-	return LS_NOACTION;
+	f->stage = 1;
+	ls_pushexecnode(e, ncond);
 }
 
-static ls_execaction_t
-ls_execeatom(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execfor(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
-	ls_lex_t const *l = &e->m->lexes[mod];
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	switch (l->types[a->nodes[node].tok])
+	uint32_t ninit = a->nodes[f->node].children[0];
+	uint32_t ncond = a->nodes[f->node].children[1];
+	uint32_t ninc = a->nodes[f->node].children[2];
+	uint32_t nbody = a->nodes[f->node].children[3];
+	
+	switch (f->stage)
 	{
-	case LS_IDENT:
+	case 0:
+		++e->scopes[e->fndepth - 1];
+		f->stage = 1;
+		ls_pushexecnode(e, ninit);
+		return;
+	case 1:
+	case 4:
+	{
+		// initializer or increment finished.
+		ls_val_t v = ls_popval(e);
+		ls_destroyval(&v);
+		break;
+	}
+	case 2:
 	{
-		ls_tok_t tok = l->toks[a->nodes[node].tok];
-		
-		char sym[LS_MAXIDENT + 1] = {0};
-		ls_readtokraw(sym, e->m->data[mod], tok);
-		
-		ls_symtab_t *st = &e->localsts[e->fndepth - 1];
-		
-		int64_t decl = ls_findsym(st, sym);
-		if (decl != -1)
+		ls_val_t vcond = ls_popval(e);
+		if (!vcond.data.bool_)
 		{
-			*out = ls_copyval(&st->vals[decl]);
-			break;
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, (ls_val_t){0});
+			return;
 		}
 		
-		decl = ls_findsym(e->globalst, sym);
-		*out = ls_copyval(&e->globalst->vals[decl]);
-		
-		break;
+		f->stage = 3;
+		ls_pushexecnode(e, nbody);
+		return;
 	}
-	case LS_LITSTR:
+	default:
 	{
-		ls_tok_t tok = l->toks[a->nodes[node].tok];
+		ls_val_t v = ls_popval(e);
+		if (e->action == LS_RETURNVALUE)
+		{
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, v);
+			return;
+		}
 		
-		char str[LS_MAXSTRING + 1] = {0};
-		ls_readtokstr(str, e->m->data[mod], tok);
+		ls_destroyval(&v);
+		if (e->action == LS_STOPITER)
+		{
+			e->action = LS_NOACTION;
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, (ls_val_t){0});
+			return;
+		}
 		
-		*out = (ls_val_t)
+		e->action = LS_NOACTION;
+		if (ls_checkcancel(e))
 		{
-			.type = LS_STRING,
-			.data.string = ls_strdup(str)
-		};
-		break;
+			return;
+		}
+		
+		f->stage = 4;
+		ls_pushexecnode(e, ninc);
+		return;
 	}
-	case LS_LITINT:
-	{
-		ls_tok_t tok = l->toks[a->nodes[node].tok];
-		*out = (ls_val_t)
-		{
-			.type = LS_INT,
-			.data.int_ = ls_readtokint(e->m->data[mod], tok)
-		};
-		break;
 	}
-	case LS_LITREAL:
+	
+	f->stage = 2;
+	ls_pushexecnode(e, ncond);
+}
+
+static void
+ls_execbreak(ls_exec_t *e, ls_execframe_t *f)
+{
+	(void)f;
+	
+	e->action = LS_STOPITER;
+	ls_retexecnode(e, (ls_val_t){0});
+}
+
+static void
+ls_execcontinue(ls_exec_t *e, ls_execframe_t *f)
+{
+	(void)f;
+	
+	e->action = LS_NEXTITER;
+	ls_retexecnode(e, (ls_val_t){0});
+}
+
+static void
+ls_execblock(ls_exec_t *e, ls_execframe_t *f)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	
+	ls_ast_t const *a = &e->m->asts[mod];
+	
+	if (!f->stage)
 	{
-		ls_tok_t tok = l->toks[a->nodes[node].tok];
-		*out = (ls_val_t)
-		{
-			.type = LS_REAL,
-			.data.real = ls_readtokreal(e->m->data[mod], tok)
-		};
-		break;
+		++e->scopes[e->fndepth - 1];
 	}
-	case LS_KWTRUE:
-		*out = (ls_val_t)
+	else
+	{
+		ls_val_t v = ls_popval(e);
+		if (e->action == LS_RETURNVALUE)
 		{
-			.type = LS_BOOL,
-			.data.bool_ = true
-		};
-		break;
-	case LS_KWFALSE:
-		*out = (ls_val_t)
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, v);
+			return;
+		}
+		
+		ls_destroyval(&v);
+		if (e->action == LS_NEXTITER || e->action == LS_STOPITER)
 		{
-			.type = LS_BOOL,
-			.data.bool_ = false
-		};
-		break;
-	default:
-		break;
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, (ls_val_t){0});
+			return;
+		}
 	}
 	
-	return LS_NOACTION;
+	if (f->stage < a->nodes[f->node].nchildren)
+	{
+		uint32_t nstmt = a->nodes[f->node].children[f->stage++];
+		ls_pushexecnode(e, nstmt);
+		return;
+	}
+	
+	ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+	ls_retexecnode(e, (ls_val_t){0});
+}
+
+static void
+ls_execeatom(ls_exec_t *e, ls_execframe_t *f)
+{
+	ls_retexecnode(e, ls_atomval(e, f->node));
 }
 
-static ls_execaction_t
-ls_execesystem(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execesystem(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_lex_t const *l = &e->m->lexes[mod];
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t ntype = a->nodes[node].children[0];
+	uint32_t ntype = a->nodes[f->node].children[0];
+	uint32_t nargs = a->nodes[f->node].nchildren - 1;
 	
-	ls_tok_t tok = l->toks[a->nodes[node].tok];
+	ls_tok_t tok = l->toks[a->nodes[f->node].tok];
 	char sym[LS_MAXIDENT + 1] = {0};
 	ls_readtokraw(sym, e->m->data[mod], tok);
 	
 	ls_toktype_t typetok = l->types[a->nodes[ntype].tok];
 	ls_primtype_t primtype = ls_toktoprim[typetok];
 	
-	int64_t sysfn = ls_findsysfn(e->sf, sym);
-	if (sysfn == -1)
-	{
-		fprintf(e->logfp, LS_ERR "system function %s not in system function table!\n", sym);
-		*out = ls_defaultval(primtype);
-		return LS_NOACTION;
-	}
-	
-	if (e->sf->rettypes[sysfn] != primtype)
+	if (!f->stage)
 	{
-		fprintf(e->logfp, LS_ERR "called system fuction %s with return type %s instead of %s!\n", sym, ls_primtypenames[primtype], ls_primtypenames[e->sf->rettypes[sysfn]]);
-		*out = ls_defaultval(primtype);
-		return LS_NOACTION;
+		int64_t sysfn = ls_findsysfn(e->sf, sym);
+		if (sysfn == -1)
+		{
+			fprintf(e->logfp, LS_ERR "system function %s not in system function table!\n", sym);
+			ls_retexecnode(e, ls_defaultval(primtype));
+			return;
+		}
+		
+		if (e->sf->rettypes[sysfn] != primtype)
+		{
+			fprintf(e->logfp, LS_ERR "called system fuction %s with return type %s instead of %s!\n", sym, ls_primtypenames[primtype], ls_primtypenames[e->sf->rettypes[sysfn]]);
+			ls_retexecnode(e, ls_defaultval(primtype));
+			return;
+		}
+		
+		if (e->sf->nargs[sysfn] != nargs)
+		{
+			fprintf(e->logfp, LS_ERR "system function %s wants %u arguments, %u given!", sym, e->sf->nargs[sysfn], nargs);
+			ls_retexecnode(e, ls_defaultval(primtype));
+			return;
+		}
+		
+		f->aux = sysfn;
 	}
 	
-	if (e->sf->nargs[sysfn] != a->nodes[node].nchildren - 1)
+	if (ls_execnext(e, f, 1, nargs + 1))
 	{
-		fprintf(e->logfp, LS_ERR "system function %s wants %u arguments, %u given!", sym, e->sf->nargs[sysfn], a->nodes[node].nchildren - 1);
-		*out = ls_defaultval(primtype);
-		return LS_NOACTION;
+		return;
 	}
 	
 	ls_val_t args[LS_MAXSYSARGS] = {0};
-	for (uint32_t i = 1; i < a->nodes[node].nchildren; ++i)
+	e->nvals -= nargs;
+	ls_memcpy(args, &e->vals[e->nvals], nargs * sizeof(ls_val_t));
+	
+	for (uint32_t i = 0; i < nargs; ++i)
 	{
-		uint32_t narg = a->nodes[node].children[i];
-		
-		ls_execfns[a->types[narg]](&args[i - 1], e, narg);
-		ls_primtype_t declargtype = e->sf->argtypes[sysfn][i - 1];
-		if (args[i - 1].type != declargtype)
+		ls_primtype_t declargtype = e->sf->argtypes[f->aux][i];
+		if (args[i].type != declargtype)
 		{
-			fprintf(e->logfp, LS_ERR "system function %s given %s for argument %u when needed %s!\n", sym, ls_primtypenames[args[i - 1].type], i, ls_primtypenames[declargtype]);
+			fprintf(e->logfp, LS_ERR "system function %s given %s for argument %u when needed %s!\n", sym, ls_primtypenames[args[i].type], i + 1, ls_primtypenames[declargtype]);
 			for (size_t j = 0; j < LS_MAXSYSARGS; ++j)
 			{
 				ls_destroyval(&args[j]);
-				*out = ls_defaultval(primtype);
-				return LS_NOACTION;
 			}
+			ls_retexecnode(e, ls_defaultval(primtype));
+			return;
 		}
 	}
 	
-	*out = e->sf->callbacks[sysfn](e, args);
+	if (e->sf->callbacks[f->aux])
+	{
+		ls_val_t v = e->sf->callbacks[f->aux](e, args);
+		for (size_t i = 0; i < LS_MAXSYSARGS; ++i)
+		{
+			ls_destroyval(&args[i]);
+		}
+		ls_retexecnode(e, v);
+		return;
+	}
+	
+	// the frame stays on top of the stack until the host completes it.
+	ls_val_t v = {0};
+	ls_sysstatus_t status = e->sf->asynccallbacks[f->aux](e, args, &v);
 	for (size_t i = 0; i < LS_MAXSYSARGS; ++i)
 	{
 		ls_destroyval(&args[i]);
 	}
-	return LS_NOACTION;
+	
+	if (status == LS_SYSPENDING)
+	{
+		e->pending = true;
+		return;
+	}
+	
+	ls_retexecnode(e, v);
 }
 
-static ls_execaction_t
-ls_exececall(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_exececall(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_lex_t const *l = &e->m->lexes[mod];
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nfunc = a->nodes[node].children[0];
+	uint32_t nargs = a->nodes[f->node].nchildren - 1;
+	
+	if (ls_execnext(e, f, 1, nargs + 1))
+	{
+		return;
+	}
+	
+	if (f->stage > nargs)
+	{
+		// the callee has finished, leaving its return value as ours.
+		--e->nframes;
+		return;
+	}
+	
+	if (ls_checkcancel(e))
+	{
+		return;
+	}
+	
+	uint32_t nfunc = a->nodes[f->node].children[0];
 	
 	ls_tok_t tok = l->toks[a->nodes[nfunc].tok];
 	char sym[LS_MAXIDENT + 1] = {0};
 	ls_readtokraw(sym, e->m->data[mod], tok);
 	
-	int64_t decl = ls_findsym(e->globalst, sym);
+	int64_t decl = ls_findsym(&e->globalst, sym);
 	
-	uint32_t dmod = e->globalst->mods[decl];
+	uint32_t dmod = e->globalst.mods[decl];
 	
 	ls_lex_t const *dl = &e->m->lexes[dmod];
 	ls_ast_t const *da = &e->m->asts[dmod];
 	
-	uint32_t nfuncdecl = e->globalst->nodes[decl];
+	uint32_t nfuncdecl = e->globalst.nodes[decl];
 	uint32_t narglist = da->nodes[nfuncdecl].children[1];
 	
+	e->nvals -= nargs;
+	
 	ls_symtab_t newlocalst = ls_createsymtab();
-	for (uint32_t i = 1; i < a->nodes[node].nchildren; ++i)
+	for (uint32_t i = 0; i < nargs; ++i)
 	{
-		uint32_t narg = a->nodes[node].children[i];
-		uint32_t nparam = da->nodes[narglist].children[i - 1];
+		uint32_t nparam = da->nodes[narglist].children[i];
 		
 		ls_tok_t paramtok = dl->toks[da->nodes[nparam].tok];
 		char paramsym[LS_MAXIDENT + 1] = {0};
 		ls_readtokraw(paramsym, e->m->data[dmod], paramtok);
 		
-		ls_val_t v = {0};
-		ls_execfns[a->types[narg]](&v, e, narg);
-		
+		ls_val_t v = e->vals[e->nvals + i];
 		ls_pushsym(&newlocalst, ls_strdup(paramsym), v.type, dmod, nparam, 0);
 		newlocalst.vals[newlocalst.nsyms - 1] = v;
+		ls_settlestr(&newlocalst.vals[newlocalst.nsyms - 1]);
 	}
 	
+	++f->stage;
 	ls_pushexecfn(e, dmod, &newlocalst);
-	ls_execfuncdecl(out, e, nfuncdecl);
-	ls_popexecfn(e);
-	
-	return LS_NOACTION;
+	ls_pushexecnode(e, nfuncdecl);
 }
 
-static ls_execaction_t
-ls_execeaccess(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeaccess(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nmhs = a->nodes[node].children[1];
-	uint32_t nrhs = a->nodes[node].nchildren == 3 ? a->nodes[node].children[2] : 0;
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
-	int64_t len = (int64_t)strlen(vl.data.string);
+	uint32_t nchildren = a->nodes[f->node].nchildren;
+	if (ls_execnext(e, f, 0, nchildren))
+	{
+		return;
+	}
 	
-	ls_val_t vm = {0};
-	ls_execfns[a->types[nmhs]](&vm, e, nmhs);
+	ls_val_t vr = nchildren == 3 ? ls_popval(e) : (ls_val_t){0};
+	ls_val_t vm = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
+	int64_t len = ls_strlen(&vl);
 	
-	if (!nrhs)
+	if (nchildren == 2)
 	{
 		if (vm.data.int_ < 0 || vm.data.int_ >= len)
 		{
 			fprintf(e->logfp, LS_ERR "tried to access (read) index %ld of a string with length %ld!\n", vm.data.int_, len);
 			ls_destroyval(&vl);
-			*out = ls_defaultval(LS_STRING);
-			return LS_NOACTION;
+			ls_retexecnode(e, ls_defaultval(LS_STRING));
+			return;
 		}
 		
-		*out = (ls_val_t)
-		{
-			.type = LS_STRING,
-			.data.string = ls_malloc(2)
-		};
-		out->data.string[0] = vl.data.string[vm.data.int_];
-		out->data.string[1] = 0;
-		ls_destroyval(&vl);
-		return LS_NOACTION;
+		ls_substr(&vl, vm.data.int_, 1);
+		ls_retexecnode(e, vl);
+		return;
 	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
-	
 	int64_t lb = vm.data.int_, ub = vr.data.int_;
 	
 	lb = lb < 0 ? 0 : lb;
@@ -1109,28 +2784,19 @@ ls_execeaccess(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		ub = tmp;
 	}
 	
-	*out = (ls_val_t)
-	{
-		.type = LS_STRING,
-		.data.string = ls_malloc(ub - lb + 1)
-	};
-	out->data.string[ub - lb] = 0;
-	ls_memcpy(&out->data.string[0], &vl.data.string[lb], ub - lb);
-	ls_destroyval(&vl);
-	return LS_NOACTION;
+	ls_substr(&vl, lb, ub - lb);
+	ls_retexecnode(e, vl);
 }
 
-static ls_execaction_t
-ls_execeneg(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeneg(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nopnd = a->nodes[node].children[0];
+	if (ls_execnext(e, f, 0, 1))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nopnd]](&v, e, nopnd);
+	ls_val_t v = ls_popval(e);
 	if (v.type == LS_INT)
 	{
 		v.data.int_ *= -1;
@@ -1140,49 +2806,49 @@ ls_execeneg(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		v.data.real *= -1.0;
 	}
 	
-	*out = v;
-	return LS_NOACTION;
+	ls_retexecnode(e, v);
 }
 
-static ls_execaction_t
-ls_execenot(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execenot(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nopnd = a->nodes[node].children[0];
+	if (ls_execnext(e, f, 0, 1))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nopnd]](&v, e, nopnd);
+	ls_val_t v = ls_popval(e);
 	v.data.bool_ = !v.data.bool_;
 	
-	*out = v;
-	return LS_NOACTION;
+	ls_retexecnode(e, v);
 }
 
-static ls_execaction_t
-ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_exececast(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_lex_t const *l = &e->m->lexes[mod];
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 0, 1))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nlhs]](&v, e, nlhs);
+	uint32_t nrhs = a->nodes[f->node].children[1];
+	
+	ls_val_t v = ls_popval(e);
 	
 	ls_toktype_t rhstok = l->types[a->nodes[nrhs].tok];
 	ls_primtype_t rhstype = ls_toktoprim[rhstok];
 	
+	ls_val_t out;
 	if (v.type == LS_INT)
 	{
 		if (rhstype == LS_REAL)
 		{
-			*out = (ls_val_t)
+			out = (ls_val_t)
 			{
 				.type = LS_REAL,
 				.data.real = v.data.int_
@@ -1191,16 +2857,12 @@ ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		else if (rhstype == LS_STRING)
 		{
 			char data[64];
-			sprintf(data, "%ld", v.data.int_);
-			*out = (ls_val_t)
-			{
-				.type = LS_STRING,
-				.data.string = ls_strdup(data)
-			};
+			int len = sprintf(data, "%ld", v.data.int_);
+			out = ls_newexecstr(e, data, len);
 		}
 		else // bool.
 		{
-			*out = (ls_val_t)
+			out = (ls_val_t)
 			{
 				.type = LS_BOOL,
 				.data.bool_ = !!v.data.int_
@@ -1211,7 +2873,7 @@ ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node)
 	{
 		if (rhstype == LS_INT)
 		{
-			*out = (ls_val_t)
+			out = (ls_val_t)
 			{
 				.type = LS_INT,
 				.data.int_ = v.data.real
@@ -1220,30 +2882,32 @@ ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		else // string.
 		{
 			char data[64];
-			sprintf(data, "%f", v.data.real);
-			*out = (ls_val_t)
-			{
-				.type = LS_STRING,
-				.data.string = ls_strdup(data)
-			};
+			int len = snprintf(data, sizeof(data), "%f", v.data.real);
+			out = ls_newexecstr(e, data, len < (int)sizeof(data) ? len : (int)sizeof(data) - 1);
 		}
 	}
 	else if (v.type == LS_STRING)
 	{
+		// only a number's worth of the string is considered, as it may not be
+		// null terminated.
+		char data[LS_MAXREAL + 1] = {0};
+		size_t len = ls_strlen(&v);
+		ls_memcpy(data, ls_strptr(&v), len < LS_MAXREAL ? len : LS_MAXREAL);
+		
 		if (rhstype == LS_INT)
 		{
-			*out = (ls_val_t)
+			out = (ls_val_t)
 			{
 				.type = LS_INT,
-				.data.int_ = strtoll(v.data.string, NULL, 0)
+				.data.int_ = strtoll(data, NULL, 0)
 			};
 		}
 		else // real.
 		{
-			*out = (ls_val_t)
+			out = (ls_val_t)
 			{
 				.type = LS_REAL,
-				.data.real = strtod(v.data.string, NULL)
+				.data.real = strtod(data, NULL)
 			};
 		}
 		ls_destroyval(&v);
@@ -1252,7 +2916,7 @@ ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node)
 	{
 		if (rhstype == LS_INT)
 		{
-			*out = (ls_val_t)
+			out = (ls_val_t)
 			{
 				.type = LS_INT,
 				.data.int_ = v.data.bool_
@@ -1260,590 +2924,504 @@ ls_exececast(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		}
 		else // string.
 		{
-			*out = (ls_val_t)
-			{
-				.type = LS_STRING,
-				.data.string = ls_strdup(v.data.bool_ ? "true" : "false")
-			};
+			out = v.data.bool_ ? ls_newexecstr(e, "true", 4) : ls_newexecstr(e, "false", 5);
 		}
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, out);
 }
 
-static ls_execaction_t
-ls_execemul(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execemul(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_INT,
 			.data.int_ = vl.data.int_ * vr.data.int_
-		};
+		});
 	}
 	else // real.
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_REAL,
 			.data.real = vl.data.real * vr.data.real
-		};
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execediv(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execediv(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_INT,
 			.data.int_ = vl.data.int_ / vr.data.int_
-		};
+		});
 	}
 	else // real.
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_REAL,
 			.data.real = vl.data.real / vr.data.real
-		};
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execemod(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execemod(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_INT,
 			.data.int_ = vl.data.int_ % vr.data.int_
-		};
+		});
 	}
 	else // real.
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_REAL,
 			.data.real = fmod(vl.data.real, vr.data.real)
-		};
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execeadd(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeadd(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_INT,
 			.data.int_ = vl.data.int_ + vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_REAL,
 			.data.int_ = vl.data.real + vr.data.real
-		};
+		});
 	}
 	else // string.
 	{
-		size_t leftlen = strlen(vl.data.string), rightlen = strlen(vr.data.string);
-		
-		*out = (ls_val_t)
-		{
-			.type = LS_STRING,
-			.data.string = ls_malloc(leftlen + rightlen + 1)
-		};
-		ls_memcpy(&out->data.string[0], &vl.data.string[0], leftlen);
-		ls_memcpy(&out->data.string[leftlen], &vr.data.string[0], rightlen);
-		out->data.string[leftlen + rightlen] = 0;
+		ls_val_t out = ls_catstr(e, &vl, &vr);
 		
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, out);
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execesub(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execesub(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_INT,
 			.data.int_ = vl.data.int_ - vr.data.int_
-		};
+		});
 	}
 	else // real.
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_REAL,
 			.data.real = vl.data.real - vr.data.real
-		};
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execeless(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeless(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.int_ < vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.real < vr.data.real
-		};
+		});
 	}
 	else // string.
 	{
-		*out = (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = strcmp(vl.data.string, vr.data.string) < 0
-		};
+		bool res = ls_cmpstr(&vl, &vr) < 0;
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = res
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execelequal(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execelequal(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.int_ <= vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.real <= vr.data.real
-		};
+		});
 	}
-	else // string.
-	{
-		*out = (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = strcmp(vl.data.string, vr.data.string) <= 0
-		};
+	else // string.
+	{
+		bool res = ls_cmpstr(&vl, &vr) <= 0;
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = res
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execegreater(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execegreater(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.int_ > vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.real > vr.data.real
-		};
+		});
 	}
 	else // string.
 	{
-		*out = (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = strcmp(vl.data.string, vr.data.string) > 0
-		};
+		bool res = ls_cmpstr(&vl, &vr) > 0;
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = res
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execegrequal(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execegrequal(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.int_ >= vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.real >= vr.data.real
-		};
+		});
 	}
 	else // string.
 	{
-		*out = (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = strcmp(vl.data.string, vr.data.string) >= 0
-		};
+		bool res = ls_cmpstr(&vl, &vr) >= 0;
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = res
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execeequal(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeequal(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.int_ == vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.real == vr.data.real
-		};
+		});
 	}
 	else // string.
 	{
-		*out = (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = !strcmp(vl.data.string, vr.data.string)
-		};
+		bool res = !ls_cmpstr(&vl, &vr);
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = res
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execenequal(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execenequal(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
 	if (vl.type == LS_INT)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.int_ != vr.data.int_
-		};
+		});
 	}
 	else if (vl.type == LS_REAL)
 	{
-		*out = (ls_val_t)
+		ls_retexecnode(e, (ls_val_t)
 		{
 			.type = LS_BOOL,
 			.data.bool_ = vl.data.real != vr.data.real
-		};
+		});
 	}
 	else // string.
 	{
-		*out = (ls_val_t)
-		{
-			.type = LS_BOOL,
-			.data.bool_ = strcmp(vl.data.string, vr.data.string)
-		};
+		bool res = ls_cmpstr(&vl, &vr);
 		ls_destroyval(&vl);
 		ls_destroyval(&vr);
+		ls_retexecnode(e, (ls_val_t)
+		{
+			.type = LS_BOOL,
+			.data.bool_ = res
+		});
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execeand(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeand(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
-	*out = (ls_val_t)
+	ls_retexecnode(e, (ls_val_t)
 	{
 		.type = LS_BOOL,
 		.data.bool_ = vl.data.bool_ && vr.data.bool_
-	};
-	return LS_NOACTION;
+	});
 }
 
-static ls_execaction_t
-ls_execeor(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeor(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
-	*out = (ls_val_t)
+	ls_retexecnode(e, (ls_val_t)
 	{
 		.type = LS_BOOL,
 		.data.bool_ = vl.data.bool_ || vr.data.bool_
-	};
-	return LS_NOACTION;
+	});
 }
 
-static ls_execaction_t
-ls_execexor(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execexor(ls_exec_t *e, ls_execframe_t *f)
 {
-	uint32_t mod = e->mods[e->fndepth - 1];
-	
-	ls_ast_t const *a = &e->m->asts[mod];
-	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
-	
-	ls_val_t vl = {0};
-	ls_execfns[a->types[nlhs]](&vl, e, nlhs);
+	if (ls_execnext(e, f, 0, 2))
+	{
+		return;
+	}
 	
-	ls_val_t vr = {0};
-	ls_execfns[a->types[nrhs]](&vr, e, nrhs);
+	ls_val_t vr = ls_popval(e);
+	ls_val_t vl = ls_popval(e);
 	
-	*out = (ls_val_t)
+	ls_retexecnode(e, (ls_val_t)
 	{
 		.type = LS_BOOL,
 		.data.bool_ = vl.data.bool_ != vr.data.bool_
-	};
-	return LS_NOACTION;
+	});
 }
 
-static ls_execaction_t
-ls_execeternary(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeternary(ls_exec_t *e, ls_execframe_t *f)
 {
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nmhs = a->nodes[node].children[1];
-	uint32_t nrhs = a->nodes[node].children[2];
-	
-	ls_val_t vcond = {0};
-	ls_execfns[a->types[nlhs]](&vcond, e, nlhs);
+	uint32_t nmhs = a->nodes[f->node].children[1];
+	uint32_t nrhs = a->nodes[f->node].children[2];
 	
-	if (vcond.data.bool_)
+	switch (f->stage)
 	{
-		ls_execfns[a->types[nmhs]](out, e, nmhs);
-	}
-	else
+	case 0:
+		ls_execnext(e, f, 0, 1);
+		return;
+	case 1:
 	{
-		ls_execfns[a->types[nrhs]](out, e, nrhs);
+		ls_val_t vcond = ls_popval(e);
+		
+		++f->stage;
+		ls_pushexecnode(e, vcond.data.bool_ ? nmhs : nrhs);
+		return;
+	}
+	default:
+		ls_retexecnode(e, ls_popval(e));
+		return;
 	}
-	return LS_NOACTION;
 }
 
-static ls_execaction_t
-ls_execeassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeassign(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nrhs]](&v, e, nrhs);
+	uint32_t nlhs = a->nodes[f->node].children[0];
 	
+	ls_val_t v = ls_popval(e);
 	ls_val_t *dst = ls_assignmentdst(e, mod, nlhs);
 	
 	if (v.type == LS_INT)
@@ -1858,26 +3436,27 @@ ls_execeassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
 	{
 		ls_destroyval(dst);
 		*dst = v;
+		ls_settlestr(dst);
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
 }
 
-static ls_execaction_t
-ls_execeaddassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execeaddassign(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nrhs]](&v, e, nrhs);
+	uint32_t nlhs = a->nodes[f->node].children[0];
 	
+	ls_val_t v = ls_popval(e);
 	ls_val_t *dst = ls_assignmentdst(e, mod, nlhs);
 	
 	if (v.type == LS_INT)
@@ -1890,33 +3469,32 @@ ls_execeaddassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
 	}
 	else // string.
 	{
-		char string[LS_MAXSTRING + 1] = {0};
-		snprintf(string, sizeof(string), "%s%s", dst->data.string, v.data.string);
+		ls_val_t out = ls_catstr(e, dst, &v);
 		
 		ls_destroyval(dst);
 		ls_destroyval(&v);
 		
-		dst->data.string = ls_strdup(string);
+		*dst = out;
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
 }
 
-static ls_execaction_t
-ls_execesubassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execesubassign(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nrhs]](&v, e, nrhs);
+	uint32_t nlhs = a->nodes[f->node].children[0];
 	
+	ls_val_t v = ls_popval(e);
 	ls_val_t *dst = ls_assignmentdst(e, mod, nlhs);
 	
 	if (v.type == LS_INT)
@@ -1928,24 +3506,24 @@ ls_execesubassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		dst->data.real -= v.data.real;
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
 }
 
-static ls_execaction_t
-ls_execemulassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execemulassign(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nrhs]](&v, e, nrhs);
+	uint32_t nlhs = a->nodes[f->node].children[0];
 	
+	ls_val_t v = ls_popval(e);
 	ls_val_t *dst = ls_assignmentdst(e, mod, nlhs);
 	
 	if (v.type == LS_INT)
@@ -1957,24 +3535,24 @@ ls_execemulassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		dst->data.real *= v.data.real;
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
 }
 
-static ls_execaction_t
-ls_execedivassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execedivassign(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nrhs]](&v, e, nrhs);
+	uint32_t nlhs = a->nodes[f->node].children[0];
 	
+	ls_val_t v = ls_popval(e);
 	ls_val_t *dst = ls_assignmentdst(e, mod, nlhs);
 	
 	if (v.type == LS_INT)
@@ -1986,24 +3564,24 @@ ls_execedivassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		dst->data.real /= v.data.real;
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
 }
 
-static ls_execaction_t
-ls_execemodassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
+static void
+ls_execemodassign(ls_exec_t *e, ls_execframe_t *f)
 {
-	(void)out;
-	
 	uint32_t mod = e->mods[e->fndepth - 1];
 	
 	ls_ast_t const *a = &e->m->asts[mod];
 	
-	uint32_t nlhs = a->nodes[node].children[0];
-	uint32_t nrhs = a->nodes[node].children[1];
+	if (ls_execnext(e, f, 1, 2))
+	{
+		return;
+	}
 	
-	ls_val_t v = {0};
-	ls_execfns[a->types[nrhs]](&v, e, nrhs);
+	uint32_t nlhs = a->nodes[f->node].children[0];
 	
+	ls_val_t v = ls_popval(e);
 	ls_val_t *dst = ls_assignmentdst(e, mod, nlhs);
 	
 	if (v.type == LS_INT)
@@ -2015,7 +3593,159 @@ ls_execemodassign(ls_val_t *out, ls_exec_t *e, uint32_t node)
 		dst->data.real = fmod(dst->data.real, v.data.real);
 	}
 	
-	return LS_NOACTION;
+	ls_retexecnode(e, (ls_val_t){0});
+}
+
+// runs a counted loop without frames for its condition and increment. the
+// bound and step symbols are resolved once, but are still read on every
+// iteration.
+static void
+ls_execxforcount(ls_exec_t *e, ls_execframe_t *f)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	
+	ls_ast_t const *a = &e->m->asts[mod];
+	
+	uint32_t ninit = a->nodes[f->node].children[0];
+	uint32_t ncond = a->nodes[f->node].children[1];
+	uint32_t ninc = a->nodes[f->node].children[2];
+	uint32_t nbody = a->nodes[f->node].children[3];
+	
+	switch (f->stage)
+	{
+	case 0:
+		++e->scopes[e->fndepth - 1];
+		f->stage = 1;
+		ls_pushexecnode(e, ninit);
+		return;
+	case 1:
+	{
+		// initializer finished, leaving the induction variable as the last local.
+		ls_val_t v = ls_popval(e);
+		ls_destroyval(&v);
+		
+		ls_pushloop(e, (ls_countedloop_t)
+		{
+			.bound = ls_resolveoperand(e, a->nodes[ncond].children[1]),
+			.step = ls_resolveoperand(e, a->nodes[ninc].children[1]),
+			.var = e->localsts[e->fndepth - 1].nsyms - 1,
+			.cmp = a->types[ncond],
+			.down = a->types[ninc] == LS_ESUBASSIGN
+		});
+		break;
+	}
+	default:
+	{
+		ls_val_t v = ls_popval(e);
+		if (e->action == LS_RETURNVALUE)
+		{
+			--e->nloops;
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, v);
+			return;
+		}
+		
+		ls_destroyval(&v);
+		if (e->action == LS_STOPITER)
+		{
+			e->action = LS_NOACTION;
+			--e->nloops;
+			ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+			ls_retexecnode(e, (ls_val_t){0});
+			return;
+		}
+		
+		e->action = LS_NOACTION;
+		if (ls_checkcancel(e))
+		{
+			return;
+		}
+		
+		ls_countedloop_t const *c = &e->loops[e->nloops - 1];
+		ls_val_t *var = &e->localsts[e->fndepth - 1].vals[c->var];
+		
+		if (c->down)
+		{
+			var->data.int_ -= ls_readoperand(e, &c->step);
+		}
+		else
+		{
+			var->data.int_ += ls_readoperand(e, &c->step);
+		}
+		break;
+	}
+	}
+	
+	ls_countedloop_t const *c = &e->loops[e->nloops - 1];
+	int64_t var = e->localsts[e->fndepth - 1].vals[c->var].data.int_;
+	
+	if (!ls_cmpint(c->cmp, var, ls_readoperand(e, &c->bound)))
+	{
+		--e->nloops;
+		ls_popsymscope(&e->localsts[e->fndepth - 1], e->scopes[e->fndepth - 1]--);
+		ls_retexecnode(e, (ls_val_t){0});
+		return;
+	}
+	
+	f->stage = 2;
+	ls_pushexecnode(e, nbody);
+}
+
+// compares with an integer literal, without evaluating it onto the value stack.
+static void
+ls_execxcmpimm(ls_exec_t *e, ls_execframe_t *f)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	
+	ls_ast_t const *a = &e->m->asts[mod];
+	
+	if (ls_execnext(e, f, 0, 1))
+	{
+		return;
+	}
+	
+	uint32_t nrhs = a->nodes[f->node].children[1];
+	
+	ls_val_t vl = ls_popval(e);
+	ls_retexecnode(e, (ls_val_t)
+	{
+		.type = LS_BOOL,
+		.data.bool_ = ls_cmpint(a->types[f->node], vl.data.int_, e->ints[mod][nrhs])
+	});
+}
+
+// tests divisibility by an integer literal without a frame for the modulo.
+static void
+ls_execxmodzero(ls_exec_t *e, ls_execframe_t *f)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	
+	ls_ast_t const *a = &e->m->asts[mod];
+	
+	uint32_t nmod = a->nodes[f->node].children[0];
+	uint32_t nlhs = a->nodes[nmod].children[0];
+	uint32_t nrhs = a->nodes[nmod].children[1];
+	
+	if (!f->stage)
+	{
+		f->stage = 1;
+		if (a->types[nlhs] != LS_EATOM)
+		{
+			ls_pushexecnode(e, nlhs);
+			return;
+		}
+		
+		ls_pushval(e, ls_atomval(e, nlhs));
+	}
+	
+	ls_val_t vl = ls_popval(e);
+	bool zero = !(vl.data.int_ % e->ints[mod][nrhs]);
+	
+	ls_retexecnode(e, (ls_val_t)
+	{
+		.type = LS_BOOL,
+		.data.bool_ = a->types[f->node] == LS_EEQUAL ? zero : !zero
+	});
 }
 
 static ls_val_t *
@@ -2032,7 +3762,75 @@ ls_assignmentdst(ls_exec_t *e, uint32_t mod, uint32_t node)
 	}
 	else
 	{
-		decl = ls_findsym(e->globalst, sym);
-		return &e->globalst->vals[decl];
+		decl = ls_findsym(&e->globalst, sym);
+		return &e->globalst.vals[decl];
+	}
+}
+
+static void
+ls_pushloop(ls_exec_t *e, ls_countedloop_t c)
+{
+	if (e->nloops >= e->loopcap)
+	{
+		size_t oldsize = ls_framebytes(e);
+		e->loopcap *= 2;
+		e->loops = ls_reallocarray(e->loops, e->loopcap, sizeof(ls_countedloop_t));
+		ls_countmem(LS_MEMFRAMES, oldsize, ls_framebytes(e));
+	}
+	
+	e->loops[e->nloops++] = c;
+}
+
+// symbols are resolved to their indices, which stay valid for the whole loop as
+// symbols declared in its body are only ever pushed above them.
+static ls_loopoperand_t
+ls_resolveoperand(ls_exec_t *e, uint32_t node)
+{
+	uint32_t mod = e->mods[e->fndepth - 1];
+	
+	ls_lex_t const *l = &e->m->lexes[mod];
+	ls_ast_t const *a = &e->m->asts[mod];
+	
+	if (l->types[a->nodes[node].tok] == LS_LITINT)
+	{
+		return (ls_loopoperand_t)
+		{
+			.imm = e->ints[mod][node],
+			.kind = LS_OPIMM
+		};
+	}
+	
+	ls_tok_t tok = l->toks[a->nodes[node].tok];
+	char sym[LS_MAXIDENT + 1] = {0};
+	ls_readtokraw(sym, e->m->data[mod], tok);
+	
+	int64_t decl = ls_findsym(&e->localsts[e->fndepth - 1], sym);
+	if (decl != -1)
+	{
+		return (ls_loopoperand_t)
+		{
+			.sym = decl,
+			.kind = LS_OPLOCAL
+		};
+	}
+	
+	return (ls_loopoperand_t)
+	{
+		.sym = ls_findsym(&e->globalst, sym),
+		.kind = LS_OPGLOBAL
+	};
+}
+
+static int64_t
+ls_readoperand(ls_exec_t const *e, ls_loopoperand_t const *o)
+{
+	switch (o->kind)
+	{
+	case LS_OPIMM:
+		return o->imm;
+	case LS_OPLOCAL:
+		return e->localsts[e->fndepth - 1].vals[o->sym].data.int_;
+	default: // global.
+		return e->globalst.vals[o->sym].data.int_;
 	}
 }
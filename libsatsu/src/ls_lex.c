@@ -85,6 +85,7 @@ ls_lex(ls_lex_t *out, char const *data, uint32_t len)
 		{(void **)&l.types, 1, sizeof(uint8_t)}
 	};
 	l.buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	ls_countmem(LS_MEMTOKENS, 0, sizeof(ls_tok_t) + sizeof(uint8_t));
 	
 	ls_addtok(&l, LS_NULL, 0, 0);
 	
@@ -295,6 +296,7 @@ ls_addtok(ls_lex_t *l, ls_toktype_t type, uint32_t pos, uint32_t len)
 		};
 		
 		l->buf = ls_reallocbatch(l->buf, reallocs, ARRSIZE(reallocs));
+		ls_countmem(LS_MEMTOKENS, l->tokcap * (sizeof(ls_tok_t) + sizeof(uint8_t)), 2 * l->tokcap * (sizeof(ls_tok_t) + sizeof(uint8_t)));
 		l->tokcap *= 2;
 	}
 	
@@ -380,6 +382,7 @@ ls_cprinttok(ls_tok_t tok, ls_toktype_t type)
 void
 ls_destroylex(ls_lex_t *l)
 {
+	ls_countmem(LS_MEMTOKENS, l->tokcap * (sizeof(ls_tok_t) + sizeof(uint8_t)), 0);
 	ls_free(l->buf);
 }
 
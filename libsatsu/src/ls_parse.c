@@ -155,6 +155,7 @@ ls_parse(ls_ast_t *out, ls_lex_t const *l)
 		{(void **)&a.types, 1, sizeof(uint8_t)}
 	};
 	a.buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	ls_countmem(LS_MEMAST, 0, sizeof(ls_node_t) + sizeof(uint8_t));
 	
 	ls_parse_t p =
 	{
@@ -171,6 +172,11 @@ ls_parse(ls_ast_t *out, ls_lex_t const *l)
 		return e;
 	}
 	
+	if (ls_conf.compactast)
+	{
+		ls_compactast(&a);
+	}
+	
 	*out = a;
 	return (ls_err_t){0};
 }
@@ -187,6 +193,7 @@ ls_addnode(ls_ast_t *a, ls_nodetype_t type)
 		};
 		
 		a->buf = ls_reallocbatch(a->buf, reallocs, ARRSIZE(reallocs));
+		ls_countmem(LS_MEMAST, a->nodecap * (sizeof(ls_node_t) + sizeof(uint8_t)), 2 * a->nodecap * (sizeof(ls_node_t) + sizeof(uint8_t)));
 		a->nodecap *= 2;
 	}
 	
@@ -196,6 +203,7 @@ ls_addnode(ls_ast_t *a, ls_nodetype_t type)
 		.childcap = 1
 	};
 	a->types[a->nnodes] = type;
+	ls_countmem(LS_MEMAST, 0, sizeof(uint32_t));
 	
 	return a->nnodes++;
 }
@@ -205,8 +213,9 @@ ls_parentnode(ls_ast_t *a, uint32_t parent, uint32_t child)
 {
 	ls_node_t *node = &a->nodes[parent];
 	
-	if (node->childcap >= node->nchildren)
+	if (node->nchildren >= node->childcap)
 	{
+		ls_countmem(LS_MEMAST, node->childcap * sizeof(uint32_t), 2 * node->childcap * sizeof(uint32_t));
 		node->childcap *= 2;
 		node->children = ls_reallocarray(node->children, node->childcap, sizeof(uint32_t));
 	}
@@ -214,6 +223,78 @@ ls_parentnode(ls_ast_t *a, uint32_t parent, uint32_t child)
 	node->children[node->nchildren++] = child;
 }
 
+// renumbers the nodes in pre-order, the order in which semantic analysis and
+// execution mostly visit them, and moves all child lists into one array shared
+// by the AST. nodes unreachable from the root are dropped. nodes must not be
+// added to the AST afterwards.
+void
+ls_compactast(ls_ast_t *a)
+{
+	// old node numbers in their new order, found with an explicit stack.
+	uint32_t *order = ls_malloc(2 * a->nnodes * sizeof(uint32_t));
+	uint32_t *stack = &order[a->nnodes];
+	uint32_t nordered = 0, nstack = 0, nchildren = 0;
+	
+	stack[nstack++] = 0;
+	while (nstack)
+	{
+		uint32_t n = stack[--nstack];
+		order[nordered++] = n;
+		nchildren += a->nodes[n].nchildren;
+		
+		for (uint32_t i = a->nodes[n].nchildren; i > 0; --i)
+		{
+			stack[nstack++] = a->nodes[n].children[i - 1];
+		}
+	}
+	
+	// the stack is no longer needed, so its space maps old numbers to new.
+	uint32_t *newids = stack;
+	for (uint32_t i = 0; i < nordered; ++i)
+	{
+		newids[order[i]] = i;
+	}
+	
+	ls_ast_t c =
+	{
+		.nnodes = nordered,
+		.nodecap = nordered
+	};
+	
+	uint32_t *children = NULL;
+	ls_allocbatch_t allocs[] =
+	{
+		{(void **)&c.nodes, nordered, sizeof(ls_node_t)},
+		{(void **)&c.types, nordered, sizeof(uint8_t)},
+		{(void **)&children, nchildren, sizeof(uint32_t)}
+	};
+	c.buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	ls_countmem(LS_MEMAST, 0, nordered * (sizeof(ls_node_t) + sizeof(uint8_t)) + nchildren * sizeof(uint32_t));
+	
+	uint32_t nextchild = 0;
+	for (uint32_t i = 0; i < nordered; ++i)
+	{
+		ls_node_t const *old = &a->nodes[order[i]];
+		
+		c.nodes[i] = (ls_node_t)
+		{
+			.children = &children[nextchild],
+			.tok = old->tok,
+			.nchildren = old->nchildren
+		};
+		c.types[i] = a->types[order[i]];
+		
+		for (uint32_t j = 0; j < old->nchildren; ++j)
+		{
+			children[nextchild++] = newids[old->children[j]];
+		}
+	}
+	
+	ls_free(order);
+	ls_destroyast(a);
+	*a = c;
+}
+
 void
 ls_printast(FILE *fp, ls_ast_t const *ast, ls_lex_t const *lex)
 {
@@ -291,8 +372,17 @@ ls_destroyast(ls_ast_t *a)
 {
 	for (size_t i = 0; i < a->nnodes; ++i)
 	{
-		ls_free(a->nodes[i].children);
+		if (a->nodes[i].childcap)
+		{
+			ls_countmem(LS_MEMAST, a->nodes[i].childcap * sizeof(uint32_t), 0);
+			ls_free(a->nodes[i].children);
+		}
+		else
+		{
+			ls_countmem(LS_MEMAST, a->nodes[i].nchildren * sizeof(uint32_t), 0);
+		}
 	}
+	ls_countmem(LS_MEMAST, a->nodecap * (sizeof(ls_node_t) + sizeof(uint8_t)), 0);
 	ls_free(a->buf);
 }
 
@@ -0,0 +1,443 @@
+// SPDX-License-Identifier: BSD-3-Clause
+
+static uint32_t ls_findprofslot(ls_profile_t const *p, uint32_t const *frames, uint32_t depth, uint32_t leafmod, uint32_t leafpos);
+static void ls_growprofslots(ls_profile_t *p);
+static uint64_t ls_hashprofframes(uint32_t const *frames, uint32_t depth);
+static bool ls_sameprofframes(ls_profile_t const *p, uint32_t a, uint32_t b);
+static void ls_profname(char out[], ls_module_t const *m, uint32_t mod, uint32_t node);
+static uint32_t ls_profline(ls_module_t const *m, uint32_t mod, uint32_t pos);
+static int64_t ls_findprofkey(uint32_t const *keys, uint32_t nkeys, uint32_t a, uint32_t b);
+static void ls_sortprofcounts(uint32_t *order, uint64_t const *counts, uint32_t n);
+
+ls_profile_t
+ls_createprofile(void)
+{
+	ls_profile_t p =
+	{
+		.stackcap = 1,
+		.slotcap = 2,
+		.framecap = 1
+	};
+	
+	ls_allocbatch_t allocs[] =
+	{
+		{(void **)&p.starts, 1, sizeof(uint32_t)},
+		{(void **)&p.depths, 1, sizeof(uint32_t)},
+		{(void **)&p.leafmods, 1, sizeof(uint32_t)},
+		{(void **)&p.leafposs, 1, sizeof(uint32_t)},
+		{(void **)&p.counts, 1, sizeof(uint64_t)}
+	};
+	p.buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	p.slots = ls_calloc(2, sizeof(uint32_t));
+	p.frames = ls_calloc(1, sizeof(uint32_t));
+	
+	return p;
+}
+
+void
+ls_destroyprofile(ls_profile_t *p)
+{
+	ls_free(p->frames);
+	ls_free(p->slots);
+	ls_free(p->buf);
+}
+
+// frames holds the (module, function declaration node) pair of every function
+// on the stack, outermost first. the leaf is the position of the token being
+// executed in the innermost function.
+void
+ls_addprofsample(
+	ls_profile_t *p,
+	uint32_t const *frames,
+	uint32_t depth,
+	uint32_t leafmod,
+	uint32_t leafpos,
+	uint64_t weight
+)
+{
+	p->nsamples += weight;
+	
+	// the table is kept at most half full.
+	if (2 * (p->nstacks + 1) > p->slotcap)
+	{
+		ls_growprofslots(p);
+	}
+	
+	uint32_t slot = ls_findprofslot(p, frames, depth, leafmod, leafpos);
+	if (p->slots[slot])
+	{
+		p->counts[p->slots[slot] - 1] += weight;
+		return;
+	}
+	
+	if (p->nstacks >= p->stackcap)
+	{
+		ls_reallocbatch_t reallocs[] =
+		{
+			{(void **)&p->starts, p->stackcap, 2 * p->stackcap, sizeof(uint32_t)},
+			{(void **)&p->depths, p->stackcap, 2 * p->stackcap, sizeof(uint32_t)},
+			{(void **)&p->leafmods, p->stackcap, 2 * p->stackcap, sizeof(uint32_t)},
+			{(void **)&p->leafposs, p->stackcap, 2 * p->stackcap, sizeof(uint32_t)},
+			{(void **)&p->counts, p->stackcap, 2 * p->stackcap, sizeof(uint64_t)}
+		};
+		
+		p->buf = ls_reallocbatch(p->buf, reallocs, ARRSIZE(reallocs));
+		p->stackcap *= 2;
+	}
+	
+	while (p->nframes + 2 * depth > p->framecap)
+	{
+		p->framecap *= 2;
+		p->frames = ls_reallocarray(p->frames, p->framecap, sizeof(uint32_t));
+	}
+	
+	ls_memcpy(&p->frames[p->nframes], frames, 2 * depth * sizeof(uint32_t));
+	
+	p->starts[p->nstacks] = p->nframes;
+	p->depths[p->nstacks] = depth;
+	p->leafmods[p->nstacks] = leafmod;
+	p->leafposs[p->nstacks] = leafpos;
+	p->counts[p->nstacks] = weight;
+	p->slots[slot] = p->nstacks + 1;
+	
+	p->nframes += 2 * depth;
+	++p->nstacks;
+}
+
+// writes one line per sampled stack of functions, with their names separated by
+// semicolons and followed by the sample count. this is the collapsed stack
+// format taken by flame graph tools. stacks differing only in their leaf
+// position are written together.
+void
+ls_printprofstacks(FILE *fp, ls_profile_t const *p, ls_module_t const *m)
+{
+	// stacks are grouped by their frames through a table of the first stack of
+	// every group plus one, kept at most half full.
+	uint32_t cap = 2;
+	while (cap < 2 * p->nstacks)
+	{
+		cap *= 2;
+	}
+	
+	uint32_t *slots = ls_calloc(cap, sizeof(uint32_t));
+	uint32_t *firsts = ls_malloc((p->nstacks + 1) * sizeof(uint32_t));
+	uint64_t *counts = ls_calloc(p->nstacks + 1, sizeof(uint64_t));
+	uint32_t ngroups = 0;
+	
+	for (uint32_t i = 0; i < p->nstacks; ++i)
+	{
+		uint32_t slot = ls_hashprofframes(&p->frames[p->starts[i]], p->depths[i]) & (cap - 1);
+		while (slots[slot] && !ls_sameprofframes(p, i, slots[slot] - 1))
+		{
+			slot = (slot + 1) & (cap - 1);
+		}
+		
+		if (!slots[slot])
+		{
+			slots[slot] = i + 1;
+			firsts[ngroups++] = i;
+		}
+		counts[slots[slot] - 1] += p->counts[i];
+	}
+	
+	for (uint32_t i = 0; i < ngroups; ++i)
+	{
+		uint32_t first = firsts[i];
+		uint32_t const *frames = &p->frames[p->starts[first]];
+		for (uint32_t j = 0; j < p->depths[first]; ++j)
+		{
+			char name[LS_MAXIDENT + 1] = {0};
+			ls_profname(name, m, frames[2 * j], frames[2 * j + 1]);
+			fprintf(fp, j ? ";%s" : "%s", name);
+		}
+		fprintf(fp, " %" PRIu64 "\n", counts[first]);
+	}
+	
+	ls_free(counts);
+	ls_free(firsts);
+	ls_free(slots);
+}
+
+// writes the self and total samples of every function, then the samples of
+// every source line. a function counts towards total samples once per sample,
+// however many times it recurses.
+void
+ls_printproftable(FILE *fp, ls_profile_t const *p, ls_module_t const *m)
+{
+	// functions and lines are keyed by (module, node) and (module, line).
+	uint32_t *fnkeys = ls_malloc(2 * (p->nframes + 1) * sizeof(uint32_t));
+	uint64_t *selfs = ls_calloc(p->nframes + 1, sizeof(uint64_t));
+	uint64_t *totals = ls_calloc(p->nframes + 1, sizeof(uint64_t));
+	uint32_t *linekeys = ls_malloc(2 * (p->nstacks + 1) * sizeof(uint32_t));
+	uint64_t *linecounts = ls_calloc(p->nstacks + 1, sizeof(uint64_t));
+	uint32_t nfns = 0, nlines = 0;
+	
+	for (uint32_t i = 0; i < p->nstacks; ++i)
+	{
+		uint32_t const *frames = &p->frames[p->starts[i]];
+		for (uint32_t j = 0; j < p->depths[i]; ++j)
+		{
+			int64_t fn = ls_findprofkey(fnkeys, nfns, frames[2 * j], frames[2 * j + 1]);
+			if (fn == -1)
+			{
+				fn = nfns++;
+				fnkeys[2 * fn] = frames[2 * j];
+				fnkeys[2 * fn + 1] = frames[2 * j + 1];
+			}
+			
+			// only count the outermost occurrence of recursive functions.
+			if (ls_findprofkey(frames, j, frames[2 * j], frames[2 * j + 1]) == -1)
+			{
+				totals[fn] += p->counts[i];
+			}
+			
+			if (j == p->depths[i] - 1)
+			{
+				selfs[fn] += p->counts[i];
+			}
+		}
+		
+		uint32_t mod = p->leafmods[i];
+		uint32_t line = ls_profline(m, mod, p->leafposs[i]);
+		
+		int64_t l = ls_findprofkey(linekeys, nlines, mod, line);
+		if (l == -1)
+		{
+			l = nlines++;
+			linekeys[2 * l] = mod;
+			linekeys[2 * l + 1] = line;
+		}
+		linecounts[l] += p->counts[i];
+	}
+	
+	uint64_t nsamples = p->nsamples ? p->nsamples : 1;
+	
+	uint32_t *order = ls_malloc(((nfns > nlines ? nfns : nlines) + 1) * sizeof(uint32_t));
+	
+	ls_sortprofcounts(order, selfs, nfns);
+	fprintf(fp, "%-24s %10s %7s %10s %7s\n", "function", "self", "self%", "total", "total%");
+	for (uint32_t j = 0; j < nfns; ++j)
+	{
+		uint32_t i = order[j];
+		char name[LS_MAXIDENT + 1] = {0};
+		ls_profname(name, m, fnkeys[2 * i], fnkeys[2 * i + 1]);
+		fprintf(
+			fp,
+			"%-24s %10" PRIu64 " %6.2f%% %10" PRIu64 " %6.2f%%\n",
+			name,
+			selfs[i],
+			100.0 * selfs[i] / nsamples,
+			totals[i],
+			100.0 * totals[i] / nsamples
+		);
+	}
+	
+	ls_sortprofcounts(order, linecounts, nlines);
+	fprintf(fp, "\n%-40s %10s %7s\n", "line", "samples", "%");
+	for (uint32_t j = 0; j < nlines; ++j)
+	{
+		uint32_t i = order[j];
+		char loc[512];
+		snprintf(loc, sizeof(loc), "%s:%u", m->names[linekeys[2 * i]], linekeys[2 * i + 1]);
+		fprintf(fp, "%-40s %10" PRIu64 " %6.2f%%\n", loc, linecounts[i], 100.0 * linecounts[i] / nsamples);
+	}
+	
+	ls_free(order);
+	ls_free(linecounts);
+	ls_free(linekeys);
+	ls_free(totals);
+	ls_free(selfs);
+	ls_free(fnkeys);
+}
+
+ls_trace_t
+ls_createtrace(ls_module_t const *m)
+{
+	ls_trace_t t =
+	{
+		.counts = ls_calloc(m->nmods, sizeof(uint64_t *)),
+		.times = ls_calloc(m->nmods, sizeof(uint64_t *)),
+		.nmods = m->nmods
+	};
+	
+	for (uint32_t i = 0; i < m->nmods; ++i)
+	{
+		t.counts[i] = ls_calloc(m->asts[i].nnodes, sizeof(uint64_t));
+		t.times[i] = ls_calloc(m->asts[i].nnodes, sizeof(uint64_t));
+	}
+	
+	return t;
+}
+
+void
+ls_destroytrace(ls_trace_t *t)
+{
+	for (uint32_t i = 0; i < t->nmods; ++i)
+	{
+		ls_free(t->counts[i]);
+		ls_free(t->times[i]);
+	}
+	ls_free(t->counts);
+	ls_free(t->times);
+}
+
+// sums the trace onto the source lines of a module. counts and times need one
+// zeroed entry per line. a line counts as executed as often as its most
+// executed node, while the times of its nodes add up.
+void
+ls_tracelines(
+	ls_trace_t const *t,
+	ls_module_t const *m,
+	uint32_t mod,
+	uint64_t *counts,
+	uint64_t *times
+)
+{
+	ls_lex_t const *l = &m->lexes[mod];
+	ls_ast_t const *a = &m->asts[mod];
+	
+	// tokens are in source order, so their lines are found in one pass.
+	uint32_t *toklines = ls_malloc((l->ntoks + 1) * sizeof(uint32_t));
+	uint32_t line = 0, pos = 0;
+	for (uint32_t i = 0; i < l->ntoks; ++i)
+	{
+		for (; pos < l->toks[i].pos && pos < m->lens[mod]; ++pos)
+		{
+			line += m->data[mod][pos] == '\n';
+		}
+		toklines[i] = line;
+	}
+	
+	for (uint32_t i = 0; i < a->nnodes; ++i)
+	{
+		uint32_t nodeline = toklines[a->nodes[i].tok];
+		counts[nodeline] = t->counts[mod][i] > counts[nodeline] ? t->counts[mod][i] : counts[nodeline];
+		times[nodeline] += t->times[mod][i];
+	}
+	
+	ls_free(toklines);
+}
+
+// finds the slot of the matching stack, or the empty slot where it belongs.
+static uint32_t
+ls_findprofslot(
+	ls_profile_t const *p,
+	uint32_t const *frames,
+	uint32_t depth,
+	uint32_t leafmod,
+	uint32_t leafpos
+)
+{
+	uint64_t hash = ls_hashprofframes(frames, depth);
+	hash = (hash ^ leafmod) * 0x100000001b3;
+	hash = (hash ^ leafpos) * 0x100000001b3;
+	
+	for (uint32_t slot = hash & (p->slotcap - 1);; slot = (slot + 1) & (p->slotcap - 1))
+	{
+		if (!p->slots[slot])
+		{
+			return slot;
+		}
+		
+		uint32_t i = p->slots[slot] - 1;
+		if (p->depths[i] != depth || p->leafmods[i] != leafmod || p->leafposs[i] != leafpos)
+		{
+			continue;
+		}
+		
+		if (!memcmp(&p->frames[p->starts[i]], frames, 2 * depth * sizeof(uint32_t)))
+		{
+			return slot;
+		}
+	}
+}
+
+static void
+ls_growprofslots(ls_profile_t *p)
+{
+	ls_free(p->slots);
+	p->slotcap *= 2;
+	p->slots = ls_calloc(p->slotcap, sizeof(uint32_t));
+	
+	for (uint32_t i = 0; i < p->nstacks; ++i)
+	{
+		uint32_t const *frames = &p->frames[p->starts[i]];
+		uint32_t slot = ls_findprofslot(p, frames, p->depths[i], p->leafmods[i], p->leafposs[i]);
+		p->slots[slot] = i + 1;
+	}
+}
+
+// FNV-1a over the (module, node) pairs of the frames.
+static uint64_t
+ls_hashprofframes(uint32_t const *frames, uint32_t depth)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	for (uint32_t i = 0; i < 2 * depth; ++i)
+	{
+		hash ^= frames[i];
+		hash *= 0x100000001b3;
+	}
+	
+	return hash;
+}
+
+static bool
+ls_sameprofframes(ls_profile_t const *p, uint32_t a, uint32_t b)
+{
+	if (p->depths[a] != p->depths[b])
+	{
+		return false;
+	}
+	
+	uint32_t const *aframes = &p->frames[p->starts[a]];
+	uint32_t const *bframes = &p->frames[p->starts[b]];
+	return !memcmp(aframes, bframes, 2 * p->depths[a] * sizeof(uint32_t));
+}
+
+static void
+ls_profname(char out[], ls_module_t const *m, uint32_t mod, uint32_t node)
+{
+	ls_tok_t tok = m->lexes[mod].toks[m->asts[mod].nodes[node].tok];
+	ls_readtokraw(out, m->data[mod], tok);
+}
+
+static uint32_t
+ls_profline(ls_module_t const *m, uint32_t mod, uint32_t pos)
+{
+	uint32_t line = 1;
+	for (uint32_t i = 0; i < pos && i < m->lens[mod]; ++i)
+	{
+		line += m->data[mod][i] == '\n';
+	}
+	
+	return line;
+}
+
+static int64_t
+ls_findprofkey(uint32_t const *keys, uint32_t nkeys, uint32_t a, uint32_t b)
+{
+	for (uint32_t i = 0; i < nkeys; ++i)
+	{
+		if (keys[2 * i] == a && keys[2 * i + 1] == b)
+		{
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+// orders the indices of counts from the highest count to the lowest.
+static void
+ls_sortprofcounts(uint32_t *order, uint64_t const *counts, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		uint32_t j = i;
+		for (; j > 0 && counts[order[j - 1]] < counts[i]; --j)
+		{
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+	}
+}
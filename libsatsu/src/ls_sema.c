@@ -38,6 +38,8 @@ ls_primtype_t ls_toktoprim[LS_TOKTYPE_END] =
 	[LS_KWVOID] = LS_VOID
 };
 
+static size_t ls_symbytes(uint32_t n);
+static void ls_countsym(char const *sym, bool alloc);
 static ls_err_t ls_redefinition(ls_module_t const *m, uint32_t mod, ls_symtab_t const *st, ls_tok_t cur, int64_t prev);
 static ls_err_t ls_semafuncdecl(ls_sema_t *s, uint32_t node);
 static ls_err_t ls_semalocaldecl(ls_sema_t *s, uint32_t node);
@@ -515,6 +517,7 @@ ls_createsymtab(void)
 		{(void **)&st.vals, 1, sizeof(ls_val_t)}
 	};
 	st.buf = ls_allocbatch(allocs, ARRSIZE(allocs));
+	ls_countmem(LS_MEMSYMTABS, 0, ls_symbytes(1));
 	
 	return st;
 }
@@ -555,9 +558,12 @@ ls_pushsym(
 		};
 		
 		st->buf = ls_reallocbatch(st->buf, reallocs, ARRSIZE(reallocs));
+		ls_countmem(LS_MEMSYMTABS, ls_symbytes(st->symcap), ls_symbytes(2 * st->symcap));
 		st->symcap *= 2;
 	}
 	
+	ls_countsym(sym, true);
+	
 	st->syms[st->nsyms] = sym;
 	st->types[st->nsyms] = type;
 	st->mods[st->nsyms] = mod;
@@ -573,8 +579,10 @@ ls_destroysymtab(ls_symtab_t *st)
 	for (size_t i = 0; i < st->nsyms; ++i)
 	{
 		ls_destroyval(&st->vals[i]);
+		ls_countsym(st->syms[i], false);
 		ls_free(st->syms[i]);
 	}
+	ls_countmem(LS_MEMSYMTABS, ls_symbytes(st->symcap), 0);
 	ls_free(st->buf);
 }
 
@@ -585,10 +593,33 @@ ls_popsymscope(ls_symtab_t *st, uint16_t scope)
 	{
 		--st->nsyms;
 		ls_destroyval(&st->vals[st->nsyms]);
+		ls_countsym(st->syms[st->nsyms], false);
 		ls_free(st->syms[st->nsyms]);
 	}
 }
 
+// the size of the arrays of a symbol table with a capacity of n symbols.
+static size_t
+ls_symbytes(uint32_t n)
+{
+	return n * (sizeof(char *) + sizeof(uint8_t) + 2 * sizeof(uint32_t) + sizeof(uint16_t) + sizeof(ls_val_t));
+}
+
+// counts the allocation or release of a symbol name. symbols are pushed and
+// popped on every scope and call, so the name is only measured when memory is
+// being counted at all.
+static void
+ls_countsym(char const *sym, bool alloc)
+{
+	if (!ls_conf.memstats)
+	{
+		return;
+	}
+	
+	size_t size = strlen(sym) + 1;
+	ls_countmem(LS_MEMSYMTABS, alloc ? 0 : size, alloc ? size : 0);
+}
+
 // ls_typeof() assumes that you are getting the type of a node which has already
 // been semantically analyzed; the function only handles the happy path.
 ls_primtype_t
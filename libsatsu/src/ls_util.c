@@ -1,5 +1,17 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
+char const *ls_memcatnames[LS_MEMCAT_END] =
+{
+	"tokens",
+	"ast",
+	"symtabs",
+	"strings",
+	"frames",
+	"arena"
+};
+
+static ls_memstats_t ls_curmemstats;
+
 void
 ls_destroyerr(ls_err_t *err)
 {
@@ -153,10 +165,176 @@ ls_cprintf(char const *fmt, ...)
 	
 	va_end(args);
 	
-	for (size_t i = 0; msg[i]; ++i)
+	ls_cwrite(msg, (size_t)rc < sizeof(msg) ? (size_t)rc : sizeof(msg) - 1);
+	
+	return rc;
+}
+
+// the per-character hooks are used as a fallback for hosts which only provide
+// those.
+void
+ls_cwrite(char const *buf, size_t len)
+{
+	if (ls_conf.cwrite)
 	{
-		ls_conf.cput(msg[i]);
+		ls_conf.cwrite(buf, len);
+		return;
 	}
 	
-	return rc;
+	for (size_t i = 0; i < len; ++i)
+	{
+		ls_conf.cput(buf[i]);
+	}
+}
+
+int64_t
+ls_cread(char *buf, size_t cap)
+{
+	if (ls_conf.cread)
+	{
+		return ls_conf.cread(buf, cap);
+	}
+	
+	if (!cap)
+	{
+		return 0;
+	}
+	
+	int c = ls_conf.cget();
+	if (c == LS_CIGNORE || c == LS_CERR)
+	{
+		return c;
+	}
+	
+	buf[0] = c;
+	return 1;
+}
+
+// memory is only ever allocated from the newest chunk, whose header is a
+// multiple of LS_ARENAALIGN in size. returns NULL once the chunks would exceed
+// LS_ARENALIMIT bytes in total, in which case the caller should fall back to
+// the heap.
+void *
+ls_arenaalloc(ls_arena_t *a, size_t n)
+{
+	size_t need = (n + LS_ARENAALIGN - 1) / LS_ARENAALIGN * LS_ARENAALIGN;
+	if (!a->chunks || a->chunks->used + need > a->chunks->size)
+	{
+		size_t size = a->chunks ? 2 * a->chunks->size : LS_ARENACHUNK;
+		while (size < need)
+		{
+			size *= 2;
+		}
+		
+		if (a->size + size > LS_ARENALIMIT)
+		{
+			return NULL;
+		}
+		
+		ls_arenachunk_t *chunk = ls_malloc(sizeof(ls_arenachunk_t) + size);
+		if (!chunk)
+		{
+			return NULL;
+		}
+		ls_countmem(LS_MEMARENA, 0, sizeof(ls_arenachunk_t) + size);
+		
+		*chunk = (ls_arenachunk_t)
+		{
+			.prev = a->chunks,
+			.size = size
+		};
+		a->chunks = chunk;
+		a->size += size;
+	}
+	
+	uint8_t *base = (uint8_t *)(a->chunks + 1);
+	void *p = &base[a->chunks->used];
+	a->chunks->used += need;
+	
+	return p;
+}
+
+// releases all memory allocated from the arena.
+void
+ls_destroyarena(ls_arena_t *a)
+{
+	while (a->chunks)
+	{
+		ls_arenachunk_t *prev = a->chunks->prev;
+		ls_countmem(LS_MEMARENA, sizeof(ls_arenachunk_t) + a->chunks->size, 0);
+		ls_free(a->chunks);
+		a->chunks = prev;
+	}
+	a->size = 0;
+}
+
+// records a change in the size of some memory of the category. a size of zero
+// means the memory was (or will be) freed.
+void
+ls_countmem(ls_memcat_t cat, size_t oldsize, size_t newsize)
+{
+	if (!ls_conf.memstats)
+	{
+		return;
+	}
+	
+	ls_memstats_t *ms = &ls_curmemstats;
+	
+	ms->cur[cat] += newsize - oldsize;
+	ms->curtotal += newsize - oldsize;
+	
+	if (newsize)
+	{
+		++ms->nallocs[cat];
+	}
+	else
+	{
+		++ms->nfrees[cat];
+	}
+	
+	ms->peak[cat] = ms->cur[cat] > ms->peak[cat] ? ms->cur[cat] : ms->peak[cat];
+	ms->peaktotal = ms->curtotal > ms->peaktotal ? ms->curtotal : ms->peaktotal;
+}
+
+ls_memstats_t
+ls_memstats(void)
+{
+	return ls_curmemstats;
+}
+
+void
+ls_printmemstats(FILE *fp, ls_memstats_t const *ms)
+{
+	fprintf(fp, "%-10s %12s %12s %12s %12s\n", "category", "current", "peak", "allocs", "frees");
+	for (size_t i = 0; i < LS_MEMCAT_END; ++i)
+	{
+		fprintf(
+			fp,
+			"%-10s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+			ls_memcatnames[i],
+			ms->cur[i],
+			ms->peak[i],
+			ms->nallocs[i],
+			ms->nfrees[i]
+		);
+	}
+	fprintf(fp, "%-10s %12" PRIu64 " %12" PRIu64 "\n", "total", ms->curtotal, ms->peaktotal);
+}
+
+void
+ls_cprintmemstats(ls_memstats_t const *ms)
+{
+	ls_cprintf("%-10s %12s %12s %12s %12s\n", "category", "current", "peak", "allocs", "frees");
+	for (size_t i = 0; i < LS_MEMCAT_END; ++i)
+	{
+		ls_cprintf(
+			"%-10s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+			ls_memcatnames[i],
+			ms->cur[i],
+			ms->peak[i],
+			ms->nallocs[i],
+			ms->nfrees[i]
+		);
+	}
+	ls_cprintf("%-10s %12" PRIu64 " %12" PRIu64 "\n", "total", ms->curtotal, ms->peaktotal);
 }
@@ -3,6 +3,7 @@
 #ifndef LS_SATSU_H
 #define LS_SATSU_H
 
+#include <signal.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -24,6 +25,7 @@
 #define LS_NULL 0
 #define LS_MAXIDENT 63
 #define LS_MAXSTRING 1023
+#define LS_MAXSMALLSTR 15
 #define LS_MAXINT 63
 #define LS_MAXREAL 63
 #define LS_BATCHALIGN 16
@@ -31,6 +33,11 @@
 #define LS_MAXSYSARGS 6
 #define LS_CIGNORE 0x1fffffff
 #define LS_CERR 0x2fffffff
+#define LS_CBUFSIZE 4096
+#define LS_FDBUFSIZE 65536
+#define LS_ARENACHUNK 65536
+#define LS_ARENAALIGN 16
+#define LS_ARENALIMIT 67108864
 
 //--------------------//
 // enumeration values //
@@ -174,6 +181,39 @@ typedef enum ls_valuetype
 	LS_RVALUE
 } ls_valuetype_t;
 
+typedef enum ls_execstatus
+{
+	LS_EXECDONE = 0,
+	LS_EXECYIELD,
+	LS_EXECPENDING,
+	LS_EXECCANCELLED
+} ls_execstatus_t;
+
+typedef enum ls_sysstatus
+{
+	LS_SYSDONE = 0,
+	LS_SYSPENDING
+} ls_sysstatus_t;
+
+typedef enum ls_memcat
+{
+	LS_MEMTOKENS = 0,
+	LS_MEMAST,
+	LS_MEMSYMTABS,
+	LS_MEMSTRINGS,
+	LS_MEMFRAMES,
+	LS_MEMARENA,
+	
+	LS_MEMCAT_END
+} ls_memcat_t;
+
+typedef enum ls_strkind
+{
+	LS_HEAPSTR = 0,
+	LS_MAPSTR,
+	LS_ARENASTR
+} ls_strkind_t;
+
 //----------------//
 // internal types //
 //----------------//
@@ -204,6 +244,20 @@ typedef struct ls_reallocbatch
 	size_t oldn, newn, size;
 } ls_reallocbatch_t;
 
+typedef struct ls_arenachunk
+{
+	struct ls_arenachunk *prev;
+	size_t size, used;
+} ls_arenachunk_t;
+
+// a bump allocator whose memory is only released all at once. it holds at most
+// LS_ARENALIMIT bytes.
+typedef struct ls_arena
+{
+	ls_arenachunk_t *chunks;
+	size_t size;
+} ls_arena_t;
+
 typedef struct ls_tok
 {
 	uint32_t pos, len;
@@ -217,6 +271,8 @@ typedef struct ls_lex
 	uint32_t ntoks, tokcap;
 } ls_lex_t;
 
+// a child capacity of zero means that the children are a range of the shared
+// child array of a compacted AST, rather than a separate allocation.
 typedef struct ls_node
 {
 	uint32_t *children;
@@ -244,16 +300,38 @@ typedef struct ls_module
 	uint32_t nmods, modcap;
 } ls_module_t;
 
+typedef struct ls_strbuf
+{
+	char *data;
+	size_t len;
+	uint32_t refs;
+	uint8_t kind; // ls_strkind_t.
+} ls_strbuf_t;
+
+// a long string is a view into a (possibly larger) shared buffer, while a short
+// one is stored in the value itself.
+typedef struct ls_strview
+{
+	ls_strbuf_t *buf;
+	uint32_t off, len;
+} ls_strview_t;
+
 typedef struct ls_val
 {
 	union
 	{
 		int64_t int_;
 		double real;
-		char *string;
+		ls_strview_t string;
+		struct
+		{
+			char data[LS_MAXSMALLSTR];
+			uint8_t len;
+		} smallstring;
 		bool bool_;
 	} data;
 	uint8_t type; // ls_primtype_t.
+	bool small; // string is in data.smallstring.
 } ls_val_t;
 
 typedef struct ls_symtab
@@ -272,16 +350,93 @@ typedef struct ls_sysfns
 	void *buf;
 	char const **names;
 	ls_val_t (**callbacks)(struct ls_exec *, ls_val_t[LS_MAXSYSARGS]);
+	ls_sysstatus_t (**asynccallbacks)(struct ls_exec *, ls_val_t[LS_MAXSYSARGS], ls_val_t *);
 	uint8_t *rettypes; // ls_primtype_t.
 	uint8_t (*argtypes)[LS_MAXSYSARGS]; // ls_primtype_t.
 	uint8_t *nargs;
 	uint32_t nfns, fncap;
 } ls_sysfns_t;
 
+// memory use of the library by category, in bytes. reallocations count as
+// allocations. memory is only counted while ls_conf.memstats is set.
+typedef struct ls_memstats
+{
+	uint64_t cur[LS_MEMCAT_END], peak[LS_MEMCAT_END];
+	uint64_t nallocs[LS_MEMCAT_END], nfrees[LS_MEMCAT_END];
+	uint64_t curtotal, peaktotal;
+} ls_memstats_t;
+
+// samples of an execution's call stack, aggregated by unique stack.
+typedef struct ls_profile
+{
+	void *buf;
+	uint32_t *starts, *depths; // (module, node) pairs in frames.
+	uint32_t *leafmods, *leafposs;
+	uint64_t *counts;
+	uint32_t nstacks, stackcap;
+	
+	// open addressing table of stack indices plus one, keyed by frames and leaf.
+	// the capacity is a power of two.
+	uint32_t *slots;
+	uint32_t slotcap;
+	
+	uint32_t *frames;
+	uint32_t nframes, framecap;
+	uint64_t nsamples;
+} ls_profile_t;
+
+// exact execution counts and nanoseconds spent per node of each module. the
+// time of a node only includes its own steps, not those of its children, except
+// for atoms evaluated in place, which are not counted separately.
+typedef struct ls_trace
+{
+	uint64_t **counts, **times;
+	uint32_t nmods;
+} ls_trace_t;
+
+// raising a cancellation token stops the executions it is set on. it may be
+// raised from another thread or from a signal handler.
+typedef struct ls_cancel
+{
+	volatile sig_atomic_t raised;
+} ls_cancel_t;
+
 typedef struct ls_conf
 {
+	// per-character console hooks, used when the block hooks are not set.
 	int (*cget)(void);
 	void (*cput)(int);
+	
+	// block console hooks. cread returns the number of bytes read, zero at the
+	// end of input, or LS_CIGNORE / LS_CERR. LS_CIGNORE tells the library to
+	// check for cancellation and then read again straight away, so cread (and
+	// cget) must only return it after blocking for a while, e.g. after a timed
+	// wait for input or an interrupted read. otherwise reads spin.
+	int64_t (*cread)(char *, size_t);
+	void (*cwrite)(char const *, size_t);
+	
+	// flush buffered console output on every newline (for interactive use).
+	bool clinebuf;
+	
+	// executions allocate the buffers of strings longer than LS_MAXSMALLSTR
+	// from an arena of their own, released all at once when the execution is
+	// destroyed. symbol tables, symbol names, and the execution's stacks and
+	// temporary buffers still use the heap. this suits short scripts, but the
+	// memory of released strings is never reused during the run. once the arena
+	// holds LS_ARENALIMIT bytes, strings are allocated from the heap again. the
+	// memory hooks and other executions are not affected.
+	bool execarena;
+	
+	// ASTs are compacted with ls_compactast() after parsing. this roughly
+	// doubles parse time, and measured gains in semantic analysis and execution
+	// are within noise, so it mainly suits hosts that keep ASTs around and
+	// want fewer, contiguous allocations.
+	bool compactast;
+	
+	// count memory use for ls_memstats(). the counters are shared by the whole
+	// library and not synchronized, so this must only be set while a single
+	// thread uses the library.
+	bool memstats;
 } ls_conf_t;
 
 //-----------------------//
@@ -309,6 +464,7 @@ extern char const *ls_toknames[LS_TOKTYPE_END];
 extern char const *ls_nodenames[LS_NODETYPE_END];
 extern char const *ls_primtypenames[LS_PRIMTYPE_END];
 extern ls_primtype_t ls_toktoprim[LS_TOKTYPE_END];
+extern char const *ls_memcatnames[LS_MEMCAT_END];
 
 //------------//
 // procedures //
@@ -322,6 +478,14 @@ uint64_t ls_alignbatch(uint64_t n);
 void *ls_allocbatch(ls_allocbatch_t *allocs, size_t nallocs);
 void *ls_reallocbatch(void *p, ls_reallocbatch_t *reallocs, size_t nreallocs);
 int32_t ls_cprintf(char const *fmt, ...);
+void ls_cwrite(char const *buf, size_t len);
+int64_t ls_cread(char *buf, size_t cap);
+void *ls_arenaalloc(ls_arena_t *a, size_t n);
+void ls_destroyarena(ls_arena_t *a);
+void ls_countmem(ls_memcat_t cat, size_t oldsize, size_t newsize);
+ls_memstats_t ls_memstats(void);
+void ls_printmemstats(FILE *fp, ls_memstats_t const *ms);
+void ls_cprintmemstats(ls_memstats_t const *ms);
 
 // lex.
 ls_err_t ls_lex(ls_lex_t *out, char const *data, uint32_t len);
@@ -338,6 +502,7 @@ void ls_destroylex(ls_lex_t *l);
 ls_err_t ls_parse(ls_ast_t *out, ls_lex_t const *l);
 uint32_t ls_addnode(ls_ast_t *a, ls_nodetype_t type);
 void ls_parentnode(ls_ast_t *a, uint32_t parent, uint32_t child);
+void ls_compactast(ls_ast_t *a);
 void ls_printast(FILE *fp, ls_ast_t const *ast, ls_lex_t const *lex);
 void ls_cprintast(ls_ast_t const *ast, ls_lex_t const *lex);
 void ls_printnode(FILE *fp, ls_ast_t const *ast, ls_lex_t const *lex, uint32_t n, uint32_t depth);
@@ -363,15 +528,41 @@ ls_valuetype_t ls_valuetypeof(ls_module_t const *m, uint32_t mod, ls_symtab_t co
 void ls_printsymtab(FILE *fp, ls_symtab_t const *st);
 void ls_cprintsymtab(ls_symtab_t const *st);
 
+// prof.
+ls_profile_t ls_createprofile(void);
+void ls_destroyprofile(ls_profile_t *p);
+void ls_addprofsample(ls_profile_t *p, uint32_t const *frames, uint32_t depth, uint32_t leafmod, uint32_t leafpos, uint64_t weight);
+void ls_printprofstacks(FILE *fp, ls_profile_t const *p, ls_module_t const *m);
+void ls_printproftable(FILE *fp, ls_profile_t const *p, ls_module_t const *m);
+ls_trace_t ls_createtrace(ls_module_t const *m);
+void ls_destroytrace(ls_trace_t *t);
+void ls_tracelines(ls_trace_t const *t, ls_module_t const *m, uint32_t mod, uint64_t *counts, uint64_t *times);
+
 // exec.
 ls_val_t ls_defaultval(ls_primtype_t type);
 ls_val_t ls_copyval(ls_val_t const *v);
 void ls_destroyval(ls_val_t *v);
+char *ls_allocstr(ls_val_t *out, size_t len);
+ls_val_t ls_newstr(char const *s, size_t len);
+char const *ls_strptr(ls_val_t const *v);
+size_t ls_strlen(ls_val_t const *v);
+char *ls_cstr(ls_val_t const *v);
 ls_sysfns_t ls_emptysysfns(void);
 ls_sysfns_t ls_basesysfns(void);
 void ls_destroysysfns(ls_sysfns_t *sf);
 int64_t ls_findsysfn(ls_sysfns_t const *sf, char const *sysfn);
 void ls_pushsysfn(ls_sysfns_t *sf, char const *name, ls_val_t (*callback)(struct ls_exec *, ls_val_t[LS_MAXSYSARGS]), ls_primtype_t rettype, ls_primtype_t argtypes[LS_MAXSYSARGS], uint8_t nargs);
+void ls_pushasyncsysfn(ls_sysfns_t *sf, char const *name, ls_sysstatus_t (*callback)(struct ls_exec *, ls_val_t[LS_MAXSYSARGS], ls_val_t *), ls_primtype_t rettype, ls_primtype_t argtypes[LS_MAXSYSARGS], uint8_t nargs);
 ls_err_t ls_exec(ls_module_t const *m, FILE *logfp, ls_sysfns_t const *sf, char const *entry);
+ls_err_t ls_createexec(struct ls_exec **out, ls_module_t const *m, FILE *logfp, ls_sysfns_t const *sf, char const *entry);
+ls_execstatus_t ls_resumeexec(struct ls_exec *e, uint32_t nsteps);
+void ls_destroyexec(struct ls_exec *e);
+void ls_completesysfn(struct ls_exec *e, ls_val_t v);
+void ls_setexecuser(struct ls_exec *e, void *user);
+void *ls_execuser(struct ls_exec const *e);
+void ls_startprofile(struct ls_exec *e, ls_profile_t *p, uint32_t hz);
+void ls_stopprofile(struct ls_exec *e);
+void ls_setexectrace(struct ls_exec *e, ls_trace_t *t);
+void ls_setexeccancel(struct ls_exec *e, ls_cancel_t const *c);
 
 #endif